@@ -70,7 +70,7 @@ set pager=1
 
 menuentry "jimirOS" {
 	echo "Loading jimir.kernel via Multiboot..."
-	multiboot /boot/jimir.kernel
+	multiboot /boot/jimir.kernel htas.topo=PP:EE
 	module /boot/userprog.elf userprog.elf
 	module /boot/ush.elf ush.elf
 EOF
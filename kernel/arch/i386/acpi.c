@@ -0,0 +1,150 @@
+#include <kernel/acpi.h>
+#include <kernel/vmm.h>
+#include <kernel/stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+#define KERNEL_LOW_MAP   0xC0000000u   /* First 4MB of physical memory */
+#define ACPI_VIRT_BASE   0xFE000000u   /* Below the AHCI window */
+#define ACPI_VIRT_SIZE   0x00400000u
+#define PAGE_SIZE        0x1000u
+#define ACPI_MAX_TABLES  32
+
+typedef struct {
+    char     signature[8];              /* "RSD PTR " */
+    uint8_t  checksum;
+    char     oem_id[6];
+    uint8_t  revision;                  /* 0 = ACPI 1.0, 2 = ACPI 2.0+ */
+    uint32_t rsdt_addr;
+    /* ACPI 2.0+ */
+    uint32_t length;
+    uint64_t xsdt_addr;
+    uint8_t  ext_checksum;
+    uint8_t  reserved[3];
+} __attribute__((packed)) acpi_rsdp_t;
+
+static uint32_t s_next_virt = ACPI_VIRT_BASE;
+static const acpi_sdt_header_t* s_root = 0;
+static bool s_root_is_xsdt = false;
+
+/* Every table the root points at: signature read once at init, the full
+   table mapped (and checksummed) on first lookup */
+static struct {
+    char signature[4];
+    uint32_t phys;
+    const acpi_sdt_header_t* table;
+} s_tables[ACPI_MAX_TABLES];
+static int s_table_count = 0;
+
+static bool checksum_ok(const void* data, uint32_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    uint8_t sum = 0;
+    for (uint32_t i = 0; i < len; i++) {
+        sum += p[i];
+    }
+    return sum == 0;
+}
+
+/* Map [phys, phys+len) into the ACPI window; mappings are never undone */
+static void* acpi_map(uint32_t phys, uint32_t len) {
+    uint32_t base = phys & ~(PAGE_SIZE - 1);
+    uint32_t span = ((phys + len - base) + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+
+    if (s_next_virt + span > ACPI_VIRT_BASE + ACPI_VIRT_SIZE) {
+        printf("acpi: mapping window exhausted\n");
+        return 0;
+    }
+    uint32_t virt = s_next_virt;
+    for (uint32_t off = 0; off < span; off += PAGE_SIZE) {
+        if (vmm_map(virt + off, base + off, 0) != 0) {
+            return 0;
+        }
+    }
+    s_next_virt += span;
+    return (void*)(virt + (phys - base));
+}
+
+/* Map a whole table: the header first to learn its length */
+static const acpi_sdt_header_t* map_table(uint32_t phys) {
+    const acpi_sdt_header_t* hdr = acpi_map(phys, sizeof(acpi_sdt_header_t));
+    if (!hdr || hdr->length < sizeof(acpi_sdt_header_t)) return 0;
+
+    uint32_t len = hdr->length;
+    if (len > sizeof(acpi_sdt_header_t)) {
+        hdr = acpi_map(phys, len);
+        if (!hdr) return 0;
+    }
+    return checksum_ok(hdr, len) ? hdr : 0;
+}
+
+static const acpi_rsdp_t* scan_rsdp(uint32_t phys, uint32_t len) {
+    for (uint32_t off = 0; off + 20 <= len; off += 16) {
+        const acpi_rsdp_t* rsdp = (const acpi_rsdp_t*)(KERNEL_LOW_MAP + phys + off);
+        if (memcmp(rsdp->signature, "RSD PTR ", 8) == 0 && checksum_ok(rsdp, 20)) {
+            return rsdp;
+        }
+    }
+    return 0;
+}
+
+int acpi_init(void) {
+    // The EBDA segment is at 0x40E; then the BIOS area 0xE0000-0xFFFFF
+    uint32_t ebda = (uint32_t)(*(volatile uint16_t*)(KERNEL_LOW_MAP + 0x40E)) << 4;
+    const acpi_rsdp_t* rsdp = 0;
+    if (ebda >= 0x80000 && ebda < 0xA0000) {
+        rsdp = scan_rsdp(ebda, 1024);
+    }
+    if (!rsdp) {
+        rsdp = scan_rsdp(0xE0000, 0x20000);
+    }
+    if (!rsdp) {
+        printf("acpi: no RSDP found\n");
+        return -1;
+    }
+
+    // Prefer the XSDT when it is addressable from 32-bit paging
+    if (rsdp->revision >= 2 && rsdp->xsdt_addr && (rsdp->xsdt_addr >> 32) == 0 &&
+        checksum_ok(rsdp, rsdp->length)) {
+        s_root = map_table((uint32_t)rsdp->xsdt_addr);
+        s_root_is_xsdt = (s_root != 0);
+    }
+    if (!s_root) {
+        s_root = map_table(rsdp->rsdt_addr);
+    }
+    if (!s_root) {
+        printf("acpi: root table missing or corrupt\n");
+        return -1;
+    }
+
+    uint32_t entry_size = s_root_is_xsdt ? 8 : 4;
+    uint32_t count = (s_root->length - sizeof(acpi_sdt_header_t)) / entry_size;
+    const uint8_t* entries = (const uint8_t*)s_root + sizeof(acpi_sdt_header_t);
+
+    for (uint32_t i = 0; i < count && s_table_count < ACPI_MAX_TABLES; i++) {
+        uint64_t phys = 0;
+        memcpy(&phys, entries + i * entry_size, entry_size);
+        if (phys == 0 || (phys >> 32) != 0) continue;
+
+        const acpi_sdt_header_t* hdr = acpi_map((uint32_t)phys, sizeof(acpi_sdt_header_t));
+        if (!hdr) break;
+        memcpy(s_tables[s_table_count].signature, hdr->signature, 4);
+        s_tables[s_table_count].phys = (uint32_t)phys;
+        s_table_count++;
+    }
+
+    printf("acpi: %s at 0x%x, revision %d, %d tables\n", s_root_is_xsdt ? "XSDT" : "RSDT",
+           s_root_is_xsdt ? (uint32_t)rsdp->xsdt_addr : rsdp->rsdt_addr, rsdp->revision,
+           s_table_count);
+    return 0;
+}
+
+const acpi_sdt_header_t* acpi_find_table(const char* signature) {
+    for (int i = 0; i < s_table_count; i++) {
+        if (memcmp(s_tables[i].signature, signature, 4) != 0) continue;
+        if (!s_tables[i].table) {
+            s_tables[i].table = map_table(s_tables[i].phys);
+        }
+        if (s_tables[i].table) return s_tables[i].table;
+    }
+    return 0;
+}
@@ -35,6 +35,11 @@ void serial_putchar(char c) {
     outb(COM1_PORT, (uint8_t)c);
 }
 
+void serial_putbyte(uint8_t b) {
+    while (!serial_is_transmit_empty()) {}
+    outb(COM1_PORT, b);
+}
+
 void serial_writestring(const char* s) {
     if (!s) return;
     while (*s) {
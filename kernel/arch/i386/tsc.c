@@ -0,0 +1,68 @@
+#include <kernel/tsc.h>
+#include <kernel/pit.h>
+#include <kernel/ports.h>
+#include <kernel/cpuid.h>
+#include <kernel/stdio.h>
+#include <stdbool.h>
+
+#define PIT_CH2      0x42
+#define PIT_CMD      0x43
+#define PIT_CH2_GATE 0x61      /* bit 0: gate, bit 1: speaker, bit 5: OUT2 */
+#define PIT_BASE_HZ  1193182u
+#define CALIBRATE_MS 10
+
+static bool s_have_tsc = false;
+static uint32_t s_khz = 0;
+
+static bool cpu_has_tsc(void) {
+    return (cpuid(1, 0).edx & (1u << 4)) != 0;
+}
+
+static inline uint64_t rdtsc(void) {
+    uint32_t lo, hi;
+    __asm__ volatile("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+void tsc_calibrate(void) {
+    if (!cpu_has_tsc()) {
+        printf("tsc: not available, using PIT ticks\n");
+        return;
+    }
+
+    /* One-shot countdown on channel 2 (gate on, speaker off), polled
+       through OUT2 so this works before interrupts are enabled. */
+    uint16_t count = (uint16_t)(PIT_BASE_HZ / (1000 / CALIBRATE_MS));
+    outb(PIT_CH2_GATE, (inb(PIT_CH2_GATE) & ~0x02) | 0x01);
+    outb(PIT_CMD, 0xB0);               /* ch2, lobyte/hibyte, mode 0 */
+    outb(PIT_CH2, (uint8_t)(count & 0xFF));
+    outb(PIT_CH2, (uint8_t)(count >> 8));
+
+    uint64_t start = rdtsc();
+    while (!(inb(PIT_CH2_GATE) & 0x20)) { }
+    uint64_t cycles = rdtsc() - start;
+
+    s_khz = (uint32_t)(cycles / CALIBRATE_MS);
+    s_have_tsc = (s_khz != 0);
+    printf("tsc: %u kHz\n", s_khz);
+}
+
+bool tsc_available(void) {
+    return s_have_tsc;
+}
+
+uint64_t tsc_read(void) {
+    if (s_have_tsc) {
+        return rdtsc();
+    }
+    uint32_t hz = pit_hz();
+    return hz ? pit_ticks() * (1000000u / hz) : 0;
+}
+
+uint32_t tsc_khz(void) {
+    return s_have_tsc ? s_khz : 1000u;
+}
+
+uint64_t tsc_cycles_to_us(uint64_t cycles) {
+    return (cycles * 1000u) / tsc_khz();
+}
@@ -1,5 +1,6 @@
 #include <kernel/bootinfo.h>
 #include <kernel/multiboot.h>
+#include <string.h>
 
 static multiboot_info_t* s_mb = 0;
 
@@ -53,3 +54,35 @@ int bootinfo_get_module(int index, void** start, uint32_t* size, const char** na
     if (name)  *name  = (const char*)(str_phys ? (str_phys + 0xC0000000u) : 0);
     return 0;
 }
+
+const char* bootinfo_cmdline(void) {
+    if (!s_mb) return "";
+    if (!(s_mb->flags & (1u<<2)) || !s_mb->cmdline) return ""; /* no cmdline */
+    return (const char*)(s_mb->cmdline + 0xC0000000u);
+}
+
+/* Does the word at p start with "key="? Stops at the first mismatch */
+static int word_has_key(const char* p, const char* key) {
+    while (*key && *p == *key) { p++; key++; }
+    return !*key && *p == '=';
+}
+
+int bootinfo_param(const char* key, char* out, unsigned len) {
+    const char* p = bootinfo_cmdline();
+    size_t klen = strlen(key);
+    while (*p) {
+        while (*p == ' ') p++;
+        if (word_has_key(p, key)) {
+            p += klen + 1;
+            unsigned n = 0;
+            while (p[n] && p[n] != ' ' && n + 1 < len) {
+                out[n] = p[n];
+                n++;
+            }
+            if (len) out[n] = 0;
+            return 0;
+        }
+        while (*p && *p != ' ') p++;
+    }
+    return -1;
+}
@@ -1,12 +1,19 @@
 /* kernel/gdt.c */
 #include <kernel/gdt.h>
+#include <kernel/cpuid.h>
 
 /* Forward declaration for the assembly function we will create. */
 /* This function will load our GDT. */
 extern void gdt_load(struct GdtPtr* gdt_ptr);
 extern void tss_load(uint16_t selector);
+extern void sysenter_entry(void);
 
-#define GDT_ENTRIES 6
+#define MSR_SYSENTER_CS  0x174
+#define MSR_SYSENTER_ESP 0x175
+#define MSR_SYSENTER_EIP 0x176
+
+#define GDT_ENTRIES 7
+#define GDT_TLS     6
 
 struct GdtEntry gdt[GDT_ENTRIES];
 struct GdtPtr   gdt_ptr;
@@ -57,6 +64,9 @@ void gdt_initialize(void) {
     uint32_t limit = sizeof(struct TssEntry) - 1;
     gdt_set_entry(5, base, limit, 0x89, 0x00);
 
+    // 7. User TLS Segment (Ring 3 data), rebased on every task switch
+    gdt_set_entry(GDT_TLS, 0, 0xFFFFFFFF, 0xF2, 0xCF);
+
     // Initialize TSS minimal fields
     for (unsigned i=0;i<sizeof(struct TssEntry)/4;i++) ((uint32_t*)&tss_entry)[i]=0;
     tss_entry.ss0 = KERNEL_DS;
@@ -75,6 +85,43 @@ void gdt_initialize(void) {
     __asm__ volatile ("ltr %%ax" :: "a"(5<<3));
 }
 
+void gdt_set_tls(uint32_t base) {
+    gdt[GDT_TLS].base_low    = (base & 0xFFFF);
+    gdt[GDT_TLS].base_middle = (base >> 16) & 0xFF;
+    gdt[GDT_TLS].base_high   = (base >> 24) & 0xFF;
+}
+
 void tss_set_kernel_stack(uint32_t esp0) {
     tss_entry.esp0 = esp0;
-}
\ No newline at end of file
+}
+
+uint32_t tss_get_kernel_stack(void) {
+    return tss_entry.esp0;
+}
+
+static inline void wrmsr(uint32_t msr, uint32_t value) {
+    __asm__ volatile("wrmsr" :: "c"(msr), "a"(value), "d"(0));
+}
+
+/* SEP is in CPUID.1:EDX, but the original Pentium Pro (family 6, model
+   < 3, stepping < 3) sets it without implementing the instructions */
+bool sysenter_supported(void) {
+    cpuid_regs_t r = cpuid(1, 0);
+    if (!(r.edx & (1u << 11))) return false;
+    uint32_t family = (r.eax >> 8) & 0xF;
+    uint32_t model = (r.eax >> 4) & 0xF;
+    uint32_t stepping = r.eax & 0xF;
+    return !(family == 6 && model < 3 && stepping < 3);
+}
+
+/* SYSENTER loads CS from the MSR and SS = CS + 8; SYSEXIT returns to
+   CS + 16 and SS + 24 at RPL 3, which is exactly our GDT order. The
+   entry lands with esp pointing at tss_entry.esp0 and loads the real
+   stack from there, so a task switch only has to update esp0. */
+bool sysenter_init(void) {
+    if (!sysenter_supported()) return false;
+    wrmsr(MSR_SYSENTER_CS, KERNEL_CS);
+    wrmsr(MSR_SYSENTER_ESP, (uint32_t)&tss_entry.esp0);
+    wrmsr(MSR_SYSENTER_EIP, (uint32_t)&sysenter_entry);
+    return true;
+}
@@ -41,11 +41,18 @@ struct IdtPtr   idt_ptr;
 /* syscall dispatcher */
 extern void syscall_dispatch(struct registers* regs);
 
+/* sysenter_entry's read of the user return address (arch/i386/sysenter.S) */
+extern char sysenter_eip_load[], sysenter_bad_stack[];
+
 void isr_fault_handler(struct registers* regs) {
     if (regs->int_num == 128) {
         syscall_dispatch(regs);
         return;
     }
+    if (regs->int_num == 14 && regs->eip == (uint32_t)sysenter_eip_load) {
+        regs->eip = (uint32_t)sysenter_bad_stack;
+        return;
+    }
     printf("--- KERNEL PANIC ---\n");
     printf("Received Exception: %d\n", regs->int_num);
     if (regs->int_num == 13) {
@@ -4,28 +4,25 @@
 #include <kernel/keyboard.h>
 #include <kernel/pit.h>
 #include <kernel/ports.h>
-#include <kernel/sched.h>
 #include <kernel/process.h>
+#include <kernel/vdso.h>
+#include <kernel/rcu.h>
+#include <kernel/idle.h>
+#include <kernel/softirq.h>
+#include <kernel/usb.h>
 
 /* Forward declare stubs from irq.S */
 extern void irq0();
 extern void irq1();
 /* ... and so on ... */
 
-static void timer_handler(struct registers* regs) {
+/* Clock and quiescent state only; RCU callbacks, USB and the scheduler
+   run from irq_exit() */
+static void timer_handler(void) {
     pit_on_tick();
-    sched_tick();
-    
-    /* Poll USB devices */
-    extern void usb_poll(void);
-    usb_poll();
-    
-    process_schedule(regs);  // Schedule user processes
-}
-
-static void keyboard_handler(void) {
-    uint8_t scancode = inb(0x60);
-    keyboard_on_scancode(scancode);
+    vdso_tick();
+    rcu_tick();
+    usb_tick();
 }
 
 /**
@@ -33,27 +30,31 @@ static void keyboard_handler(void) {
  *
  * --- THIS IS THE FIX ---
  * The signature is changed from 'struct registers regs'
- * to 'struct registers* regs'.
+ * to 'struct registers* regs'. Returns the frame irq_common_stub
+ * restores, which differs from regs when the timer switched tasks.
  */
-void irq_handler(struct registers* regs) {
+struct registers* irq_handler(struct registers* regs) {
     /* The int_num is the IDT vector (32-47). We must subtract 32
        to get the actual IRQ number (0-15) for the PIC. */
     uint8_t irq_num = regs->int_num - 32;
+    idle_irq_enter(irq_num);
+    irq_enter(irq_num);
 
     /* Handle the specific IRQ */
     /* We now use '->' (pointer) instead of '.' (value) */
     switch (irq_num) {
         case 0: /* IRQ 0: Timer */
-            timer_handler(regs);
+            timer_handler();
             break;
         case 1: /* IRQ 1: Keyboard */
-            keyboard_handler();
+            keyboard_irq();
             break;
         default:
             printf("Unhandled IRQ: %d\n", irq_num);
     }
     /* Acknowledge the interrupt by sending EOI to the PIC */
     pic_send_eoi(irq_num);
+    return irq_exit(regs, irq_num == 0);
 }
 
 /**
@@ -3,6 +3,7 @@
 #include <kernel/gdt.h>
 #include <kernel/idt.h>
 #include <kernel/pit.h>
+#include <kernel/tsc.h>
 #include <kernel/multiboot.h>
 #include <kernel/pmm.h>
 #include <kernel/vmm.h>
@@ -12,9 +13,17 @@
 #include <kernel/gdt.h>
 #include <kernel/fs.h>
 #include <kernel/block.h>
-#include <kernel/sched.h>
 #include <kernel/process.h>
 #include <kernel/ports.h>
+#include <kernel/acpi.h>
+#include <kernel/vdso.h>
+#include <kernel/htas.h>
+#include <kernel/idle.h>
+#include <kernel/futex.h>
+#include <kernel/softirq.h>
+#include <kernel/rcu.h>
+#include <kernel/usb.h>
+#include <kernel/workqueue.h>
 
 extern void enter_user_mode(void* entry, uint32_t user_stack);
 
@@ -53,6 +62,7 @@ void kernel_main(uint32_t magic, uint32_t multiboot_addr) {
 	
     /* We can now print */
     printf("Hello, Higher-Half World!\n");
+    tsc_calibrate();
     /* Initialize memory subsystems */
     if (magic == MULTIBOOT_MAGIC) {
         uint32_t mb_high = multiboot_addr + 0xC0000000u; /* higher-half view */
@@ -68,12 +78,23 @@ void kernel_main(uint32_t magic, uint32_t multiboot_addr) {
     /* Set TSS kernel stack (use current esp) for privilege transitions */
     uint32_t cur_esp; __asm__ volatile("movl %%esp, %0" : "=r"(cur_esp));
     tss_set_kernel_stack(cur_esp);
+    printf("sysenter: %s\n", sysenter_init() ? "enabled" : "not supported, int 0x80 only");
 
     /* Bootstrap a small heap at 0xC0200000, map ~64 KiB initially */
     kmalloc_init((void*)0xC0200000u, 64*1024);
     void* test = kmalloc(1024);
     printf("kmalloc(1024) -> %p (phys %x)\n", test, vmm_resolve((uint32_t)test));
 
+    /* Shared clock/identity page for user space */
+    vdso_init();
+
+    /* ACPI tables (CPU topology for HTAS) */
+    acpi_init();
+
+    /* Interrupt bottom halves, before the first device handler needs them */
+    softirq_init();
+    rcu_init();
+
     /* Init keyboard driver */
     keyboard_init();
     
@@ -90,15 +111,17 @@ void kernel_main(uint32_t magic, uint32_t multiboot_addr) {
 
     /* Init filesystem (ext2 preferred if present) */
     fs_init();
-    /* Init scheduler */
-    sched_init();
-    /* Init process management */
+    /* Init process management (the boot context becomes kthread 0) */
     process_init();
+    futex_init();
     
     /* Init HTAS scheduler */
     extern void htas_init(void);
     htas_init();
-    printf("HTAS: Initialized (4 CPUs, 2 NUMA nodes)\n");
+    printf("HTAS: Initialized (%d CPUs, %d NUMA nodes)\n", g_num_cpus, g_num_numa_nodes);
+    idle_init();
+    usb_start_thread();
+    workqueue_init();
     
     /* Accessing multiboot info (must add offset) */
     if (magic == 0x2BADB002) {
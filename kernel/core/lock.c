@@ -0,0 +1,264 @@
+#include <kernel/lock.h>
+#include <kernel/process.h>
+#include <kernel/tsc.h>
+#include <kernel/idle.h>
+#include <kernel/stdio.h>
+
+_Static_assert(MAX_PROCESSES <= 32, "mutex waiter mask holds one bit per process slot");
+
+volatile bool g_lockstat_enabled = false;
+static lockstat_t* s_registry = 0;
+
+static inline void cpu_relax(void) {
+    __asm__ volatile("pause" ::: "memory");
+}
+
+uint32_t irq_save(void) {
+    uint32_t flags;
+    __asm__ volatile("pushfl; popl %0; cli" : "=r"(flags) :: "memory");
+    return flags;
+}
+
+void irq_restore(uint32_t flags) {
+    if (flags & 0x200) {
+        __asm__ volatile("sti" ::: "memory");
+    }
+}
+
+static void stat_register(lockstat_t* st, const char* name) {
+    uint32_t flags = irq_save();
+    lockstat_t* p = s_registry;
+    while (p && p != st) {
+        p = p->next;
+    }
+    st->name = name;
+    st->acquired = st->contended = 0;
+    st->wait_total = st->wait_max = 0;
+    if (!p) {                           // Re-init keeps its place
+        st->next = s_registry;
+        s_registry = st;
+    }
+    irq_restore(flags);
+}
+
+/* Waiters take a timestamp only while lockstat is on */
+static inline uint64_t wait_start(void) {
+    return g_lockstat_enabled ? tsc_read() : 0;
+}
+
+/* Called with the lock held, so the counters need no atomics */
+static inline void stat_acquired(lockstat_t* st, bool contended, uint64_t start) {
+    if (!g_lockstat_enabled) return;
+    st->acquired++;
+    if (!contended) return;
+    st->contended++;
+    if (start) {
+        uint64_t wait = tsc_read() - start;
+        st->wait_total += wait;
+        if (wait > st->wait_max) st->wait_max = wait;
+    }
+}
+
+/* ----- ticket spinlock ----- */
+
+void spin_lock_init(spinlock_t* lock, const char* name) {
+    lock->next = 0;
+    lock->owner = 0;
+    if (name) {
+        stat_register(&lock->stat, name);
+    }
+}
+
+void spin_lock(spinlock_t* lock) {
+    uint16_t ticket = __atomic_fetch_add(&lock->next, 1, __ATOMIC_RELAXED);
+    if (__atomic_load_n(&lock->owner, __ATOMIC_ACQUIRE) == ticket) {
+        stat_acquired(&lock->stat, false, 0);
+        return;
+    }
+
+    uint64_t start = wait_start();
+    while (__atomic_load_n(&lock->owner, __ATOMIC_ACQUIRE) != ticket) {
+        cpu_relax();
+    }
+    stat_acquired(&lock->stat, true, start);
+}
+
+/* Free means next == owner; taking ticket 'owner' then holds the lock */
+bool spin_trylock(spinlock_t* lock) {
+    uint16_t ticket = __atomic_load_n(&lock->owner, __ATOMIC_ACQUIRE);
+    if (!__atomic_compare_exchange_n(&lock->next, &ticket, (uint16_t)(ticket + 1), false,
+                                     __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return false;
+    }
+    stat_acquired(&lock->stat, false, 0);
+    return true;
+}
+
+void spin_unlock(spinlock_t* lock) {
+    __atomic_store_n(&lock->owner, (uint16_t)(lock->owner + 1), __ATOMIC_RELEASE);
+}
+
+uint32_t spin_lock_irqsave(spinlock_t* lock) {
+    uint32_t flags = irq_save();
+    spin_lock(lock);
+    return flags;
+}
+
+void spin_unlock_irqrestore(spinlock_t* lock, uint32_t flags) {
+    spin_unlock(lock);
+    irq_restore(flags);
+}
+
+/* ----- MCS queue lock ----- */
+
+void mcs_lock_init(mcs_lock_t* lock, const char* name) {
+    lock->tail = 0;
+    stat_register(&lock->stat, name);
+}
+
+void mcs_lock(mcs_lock_t* lock, mcs_node_t* node) {
+    node->next = 0;
+    node->locked = 1;
+
+    mcs_node_t* prev = __atomic_exchange_n(&lock->tail, node, __ATOMIC_ACQ_REL);
+    if (!prev) {
+        stat_acquired(&lock->stat, false, 0);
+        return;
+    }
+
+    uint64_t start = wait_start();
+    __atomic_store_n(&prev->next, node, __ATOMIC_RELEASE);
+    while (__atomic_load_n(&node->locked, __ATOMIC_ACQUIRE)) {
+        cpu_relax();
+    }
+    stat_acquired(&lock->stat, true, start);
+}
+
+void mcs_unlock(mcs_lock_t* lock, mcs_node_t* node) {
+    mcs_node_t* next = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE);
+    if (!next) {
+        mcs_node_t* expected = node;
+        if (__atomic_compare_exchange_n(&lock->tail, &expected, 0, false,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+            return;                     // Nobody queued behind us
+        }
+        // A successor swapped the tail but has not linked itself yet
+        while (!(next = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE))) {
+            cpu_relax();
+        }
+    }
+    __atomic_store_n(&next->locked, 0, __ATOMIC_RELEASE);
+}
+
+uint32_t mcs_lock_irqsave(mcs_lock_t* lock, mcs_node_t* node) {
+    uint32_t flags = irq_save();
+    mcs_lock(lock, node);
+    return flags;
+}
+
+void mcs_unlock_irqrestore(mcs_lock_t* lock, mcs_node_t* node, uint32_t flags) {
+    mcs_unlock(lock, node);
+    irq_restore(flags);
+}
+
+/* ----- sleeping mutex ----- */
+
+void mutex_init(mutex_t* m, const char* name) {
+    spin_lock_init(&m->guard, 0);      // Reported as the mutex itself
+    m->owner = -1;
+    m->waiters = 0;
+    stat_register(&m->stat, name);
+}
+
+static inline uint32_t slot_bit(process_t* proc) {
+    return 1u << (uint32_t)(proc - process_get_list());
+}
+
+bool mutex_trylock(mutex_t* m) {
+    process_t* self = process_current();
+    uint32_t flags = spin_lock_irqsave(&m->guard);
+    bool got = (m->owner < 0);
+    if (got) {
+        m->owner = self ? self->pid : KERNEL_PID;
+        stat_acquired(&m->stat, false, 0);
+    }
+    spin_unlock_irqrestore(&m->guard, flags);
+    return got;
+}
+
+/* A contended locker marks itself BLOCKED and halts; the next tick
+   switches away and mutex_unlock() makes it READY again, after which it
+   competes for the lock afresh */
+void mutex_lock(mutex_t* m) {
+    process_t* self = process_current();
+    bool contended = false;
+    uint64_t start = 0;
+
+    for (;;) {
+        uint32_t flags = spin_lock_irqsave(&m->guard);
+        if (m->owner < 0) {
+            m->owner = self ? self->pid : KERNEL_PID;
+            stat_acquired(&m->stat, contended, start);
+            spin_unlock_irqrestore(&m->guard, flags);
+            return;
+        }
+        if (!contended) {
+            contended = true;
+            start = wait_start();
+        }
+        if (self) {
+            m->waiters |= slot_bit(self);
+            process_set_state(self, PROC_BLOCKED);
+        }
+        spin_unlock(&m->guard);
+
+        // Interrupts stay off from the check to the halt, so the wakeup
+        // cannot slip in between
+        do {
+            idle_wait();
+            __asm__ volatile("cli");
+        } while (self && self->state == PROC_BLOCKED);
+        irq_restore(flags);
+    }
+}
+
+void mutex_unlock(mutex_t* m) {
+    process_t* list = process_get_list();
+    uint32_t flags = spin_lock_irqsave(&m->guard);
+
+    m->owner = -1;
+    if (m->waiters) {
+        int slot = __builtin_ctz(m->waiters);
+        m->waiters &= ~(1u << slot);
+        if (list[slot].state == PROC_BLOCKED) {
+            process_set_state(&list[slot], PROC_READY);
+        }
+    }
+    spin_unlock_irqrestore(&m->guard, flags);
+}
+
+/* ----- lockstat ----- */
+
+void lockstat_set(bool enabled) {
+    g_lockstat_enabled = enabled;
+    printf("lockstat: %s\n", enabled ? "on" : "off");
+}
+
+void lockstat_reset(void) {
+    uint32_t flags = irq_save();
+    for (lockstat_t* st = s_registry; st; st = st->next) {
+        st->acquired = st->contended = 0;
+        st->wait_total = st->wait_max = 0;
+    }
+    irq_restore(flags);
+}
+
+void lockstat_print(void) {
+    printf("lockstat: %s (wait in TSC cycles, total in us)\n", g_lockstat_enabled ? "on" : "off");
+    for (lockstat_t* st = s_registry; st; st = st->next) {
+        uint64_t max = st->wait_max > 0xFFFFFFFFull ? 0xFFFFFFFFull : st->wait_max;
+        printf("  %s: %u acquired, %u contended, max wait %u, total wait %u us\n",
+               st->name ? st->name : "?", st->acquired, st->contended,
+               (uint32_t)max, (uint32_t)tsc_cycles_to_us(st->wait_total));
+    }
+}
@@ -0,0 +1,201 @@
+#include <kernel/rbtree.h>
+
+static void rotate_left(struct rb_node* x, struct rb_root* root) {
+    struct rb_node* y = x->right;
+    x->right = y->left;
+    if (y->left) y->left->parent = x;
+    y->parent = x->parent;
+    if (!x->parent) root->node = y;
+    else if (x == x->parent->left) x->parent->left = y;
+    else x->parent->right = y;
+    y->left = x;
+    x->parent = y;
+}
+
+static void rotate_right(struct rb_node* x, struct rb_root* root) {
+    struct rb_node* y = x->left;
+    x->left = y->right;
+    if (y->right) y->right->parent = x;
+    y->parent = x->parent;
+    if (!x->parent) root->node = y;
+    else if (x == x->parent->right) x->parent->right = y;
+    else x->parent->left = y;
+    y->right = x;
+    x->parent = y;
+}
+
+void rb_insert_color(struct rb_node* node, struct rb_root* root) {
+    struct rb_node* parent;
+
+    while ((parent = node->parent) && parent->color == RB_RED) {
+        struct rb_node* gparent = parent->parent;
+
+        if (parent == gparent->left) {
+            struct rb_node* uncle = gparent->right;
+            if (uncle && uncle->color == RB_RED) {
+                uncle->color = RB_BLACK;
+                parent->color = RB_BLACK;
+                gparent->color = RB_RED;
+                node = gparent;
+                continue;
+            }
+            if (node == parent->right) {
+                rotate_left(parent, root);
+                node = parent;
+                parent = node->parent;
+            }
+            parent->color = RB_BLACK;
+            gparent->color = RB_RED;
+            rotate_right(gparent, root);
+        } else {
+            struct rb_node* uncle = gparent->left;
+            if (uncle && uncle->color == RB_RED) {
+                uncle->color = RB_BLACK;
+                parent->color = RB_BLACK;
+                gparent->color = RB_RED;
+                node = gparent;
+                continue;
+            }
+            if (node == parent->left) {
+                rotate_right(parent, root);
+                node = parent;
+                parent = node->parent;
+            }
+            parent->color = RB_BLACK;
+            gparent->color = RB_RED;
+            rotate_left(gparent, root);
+        }
+    }
+
+    root->node->color = RB_BLACK;
+}
+
+/* Restore black height after removing a black node. 'node' may be NULL, so
+   its parent is passed explicitly. */
+static void erase_fixup(struct rb_node* node, struct rb_node* parent, struct rb_root* root) {
+    while (node != root->node && (!node || node->color == RB_BLACK)) {
+        if (node == parent->left) {
+            struct rb_node* sib = parent->right;
+            if (sib->color == RB_RED) {
+                sib->color = RB_BLACK;
+                parent->color = RB_RED;
+                rotate_left(parent, root);
+                sib = parent->right;
+            }
+            if ((!sib->left || sib->left->color == RB_BLACK) &&
+                (!sib->right || sib->right->color == RB_BLACK)) {
+                sib->color = RB_RED;
+                node = parent;
+                parent = node->parent;
+            } else {
+                if (!sib->right || sib->right->color == RB_BLACK) {
+                    sib->left->color = RB_BLACK;
+                    sib->color = RB_RED;
+                    rotate_right(sib, root);
+                    sib = parent->right;
+                }
+                sib->color = parent->color;
+                parent->color = RB_BLACK;
+                if (sib->right) sib->right->color = RB_BLACK;
+                rotate_left(parent, root);
+                node = root->node;
+                break;
+            }
+        } else {
+            struct rb_node* sib = parent->left;
+            if (sib->color == RB_RED) {
+                sib->color = RB_BLACK;
+                parent->color = RB_RED;
+                rotate_right(parent, root);
+                sib = parent->left;
+            }
+            if ((!sib->left || sib->left->color == RB_BLACK) &&
+                (!sib->right || sib->right->color == RB_BLACK)) {
+                sib->color = RB_RED;
+                node = parent;
+                parent = node->parent;
+            } else {
+                if (!sib->left || sib->left->color == RB_BLACK) {
+                    sib->right->color = RB_BLACK;
+                    sib->color = RB_RED;
+                    rotate_left(sib, root);
+                    sib = parent->left;
+                }
+                sib->color = parent->color;
+                parent->color = RB_BLACK;
+                if (sib->left) sib->left->color = RB_BLACK;
+                rotate_right(parent, root);
+                node = root->node;
+                break;
+            }
+        }
+    }
+    if (node) node->color = RB_BLACK;
+}
+
+static void transplant(struct rb_node* u, struct rb_node* v, struct rb_root* root) {
+    if (!u->parent) root->node = v;
+    else if (u == u->parent->left) u->parent->left = v;
+    else u->parent->right = v;
+    if (v) v->parent = u->parent;
+}
+
+void rb_erase(struct rb_node* node, struct rb_root* root) {
+    struct rb_node* child;
+    struct rb_node* parent;
+    int removed_color = node->color;
+
+    if (!node->left) {
+        child = node->right;
+        parent = node->parent;
+        transplant(node, child, root);
+    } else if (!node->right) {
+        child = node->left;
+        parent = node->parent;
+        transplant(node, child, root);
+    } else {
+        /* Two children: splice in the in-order successor. */
+        struct rb_node* succ = node->right;
+        while (succ->left) succ = succ->left;
+        removed_color = succ->color;
+        child = succ->right;
+        if (succ->parent == node) {
+            parent = succ;
+        } else {
+            parent = succ->parent;
+            transplant(succ, succ->right, root);
+            succ->right = node->right;
+            succ->right->parent = succ;
+        }
+        transplant(node, succ, root);
+        succ->left = node->left;
+        succ->left->parent = succ;
+        succ->color = node->color;
+    }
+
+    if (removed_color == RB_BLACK && root->node) {
+        erase_fixup(child, parent, root);
+    }
+
+    node->parent = node->left = node->right = NULL;
+}
+
+struct rb_node* rb_first(const struct rb_root* root) {
+    struct rb_node* n = root->node;
+    if (!n) return NULL;
+    while (n->left) n = n->left;
+    return n;
+}
+
+struct rb_node* rb_next(const struct rb_node* node) {
+    if (node->right) {
+        node = node->right;
+        while (node->left) node = node->left;
+        return (struct rb_node*)node;
+    }
+    struct rb_node* parent;
+    while ((parent = node->parent) && node == parent->right) {
+        node = parent;
+    }
+    return parent;
+}
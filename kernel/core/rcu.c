@@ -0,0 +1,168 @@
+#include <kernel/rcu.h>
+#include <kernel/lock.h>
+#include <kernel/sched.h>
+#include <kernel/softirq.h>
+
+/* One CPU runs kernel code today (HTAS CPUs are simulated on it); the
+   per-CPU state is indexed by rcu_this_cpu() so bringing up more cores
+   only needs that lookup and a higher s_online count */
+typedef struct {
+    uint32_t nesting;                   /* rcu_read_lock depth */
+    uint32_t qs_gp;                     /* Last grace period this CPU passed */
+} rcu_cpu_t;
+
+static rcu_cpu_t s_cpu[RCU_MAX_CPUS];
+static int s_online = 1;
+
+static spinlock_t s_lock;               /* Everything below */
+static bool s_lock_ready = false;
+static uint32_t s_gp_started = 0;
+static uint32_t s_gp_completed = 0;
+static uint32_t s_gp_needed = 0;        /* Newest grace period anyone waits for */
+static struct rcu_head* s_cb_head = 0;  /* Ordered by gp */
+static struct rcu_head** s_cb_tail = &s_cb_head;
+
+static inline rcu_cpu_t* rcu_this_cpu(void) {
+    return &s_cpu[0];
+}
+
+/* Wrap-safe "a is at or after b" */
+static inline bool gp_reached(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) >= 0;
+}
+
+static uint32_t rcu_lock(void) {
+    if (!s_lock_ready) {
+        spin_lock_init(&s_lock, "rcu");
+        s_lock_ready = true;
+    }
+    return spin_lock_irqsave(&s_lock);
+}
+
+void rcu_read_lock(void) {
+    rcu_this_cpu()->nesting++;
+    __asm__ volatile("" ::: "memory");
+}
+
+void rcu_read_unlock(void) {
+    __asm__ volatile("" ::: "memory");
+    rcu_this_cpu()->nesting--;
+}
+
+bool rcu_read_lock_held(void) {
+    return rcu_this_cpu()->nesting != 0;
+}
+
+/* A grace period that must start after now; starts one if none runs */
+static uint32_t gp_request(void) {
+    uint32_t target = s_gp_started + 1;
+    if (s_gp_completed == s_gp_started) {
+        s_gp_started = target;          // Idle: begin it right away
+    }
+    if (gp_reached(target, s_gp_needed)) {
+        s_gp_needed = target;
+    }
+    return target;
+}
+
+/* This CPU is quiescent. Called with s_lock held. A quiescent state
+   counts for every grace period that began before it, so while more are
+   needed the next one can start and be credited on the spot. */
+static void report_qs(rcu_cpu_t* cpu) {
+    for (;;) {
+        cpu->qs_gp = s_gp_started;
+        for (int i = 0; i < s_online; i++) {
+            if (s_cpu[i].qs_gp != s_gp_started) return;
+        }
+        s_gp_completed = s_gp_started;
+        if (gp_reached(s_gp_completed, s_gp_needed)) return;
+        s_gp_started++;
+    }
+}
+
+/* Detach the callbacks whose grace period is over; run them unlocked */
+static struct rcu_head* take_done(void) {
+    struct rcu_head* done = 0;
+    struct rcu_head** tail = &done;
+
+    while (s_cb_head && gp_reached(s_gp_completed, s_cb_head->gp)) {
+        *tail = s_cb_head;
+        tail = &s_cb_head->next;
+        s_cb_head = s_cb_head->next;
+    }
+    *tail = 0;
+    if (!s_cb_head) {
+        s_cb_tail = &s_cb_head;
+    }
+    return done;
+}
+
+static void run_callbacks(struct rcu_head* head) {
+    while (head) {
+        struct rcu_head* next = head->next;
+        head->func(head);
+        head = next;
+    }
+}
+
+/* Callbacks wait for SOFTIRQ_RCU, out of the tick and the context switch */
+static void quiescent(void) {
+    uint32_t flags = rcu_lock();
+    report_qs(rcu_this_cpu());
+    bool ready = s_cb_head && gp_reached(s_gp_completed, s_cb_head->gp);
+    spin_unlock_irqrestore(&s_lock, flags);
+    if (ready) {
+        raise_softirq(SOFTIRQ_RCU);
+    }
+}
+
+static void rcu_softirq(void) {
+    uint32_t flags = rcu_lock();
+    struct rcu_head* done = take_done();
+    spin_unlock_irqrestore(&s_lock, flags);
+    run_callbacks(done);
+}
+
+void rcu_init(void) {
+    open_softirq(SOFTIRQ_RCU, rcu_softirq);
+}
+
+void rcu_tick(void) {
+    if (rcu_this_cpu()->nesting == 0) {
+        quiescent();
+    }
+}
+
+void rcu_note_context_switch(void) {
+    quiescent();
+}
+
+void call_rcu(struct rcu_head* head, void (*func)(struct rcu_head* head)) {
+    head->func = func;
+    head->next = 0;
+
+    uint32_t flags = rcu_lock();
+    head->gp = gp_request();
+    *s_cb_tail = head;
+    s_cb_tail = &head->next;
+    spin_unlock_irqrestore(&s_lock, flags);
+}
+
+/* The caller is outside any read section, so it is quiescent throughout;
+   other CPUs get their ticks while it sleeps */
+void synchronize_rcu(void) {
+    uint32_t flags = rcu_lock();
+    uint32_t target = gp_request();
+    spin_unlock_irqrestore(&s_lock, flags);
+
+    for (;;) {
+        flags = rcu_lock();
+        report_qs(rcu_this_cpu());
+        bool done = gp_reached(s_gp_completed, target);
+        struct rcu_head* cbs = take_done();
+        spin_unlock_irqrestore(&s_lock, flags);
+        run_callbacks(cbs);
+        if (done) return;
+        sched_yield();
+    }
+}
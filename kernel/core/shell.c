@@ -9,6 +9,12 @@
 #include <kernel/kmalloc.h>
 #include <kernel/vmm.h>
 #include <kernel/htas.h>
+#include <kernel/process.h>
+#include <kernel/trace.h>
+#include <kernel/lock.h>
+#include <kernel/idle.h>
+#include <kernel/softirq.h>
+#include <kernel/workqueue.h>
 #include <string.h>
 #include <stdint.h>
 
@@ -84,7 +90,7 @@ static int readline(char* buf, size_t cap) {
             }
         }
         
-        if (key < 0) { __asm__ volatile("hlt"); continue; }
+        if (key < 0) { idle_wait(); continue; }
 
     if (key == KEY_PAGE_UP) { terminal_scroll_view(scroll_step); continue; }
     if (key == KEY_PAGE_DOWN) { terminal_scroll_view(-scroll_step); continue; }
@@ -191,7 +197,7 @@ static void cmd_help(void) {
     printf("  exec NAME    - run module by name (ELF)\n");
     printf("  ls           - list files\n");
     printf("  cat NAME     - dump a file\n");
-    printf("  ps           - list kernel threads\n");
+    printf("  ps           - list kernel threads and processes with CPU times\n");
     printf("  spawn        - create a demo thread\n");
     printf("  kdbg         - enter kernel debugger\n");
     printf("\n");
@@ -201,7 +207,17 @@ static void cmd_help(void) {
     printf("  htas-test    - run 30s benchmark with HTAS (topology-aware)\n");
     printf("  htas-full    - run FULL comparison (both schedulers back-to-back)\n");
     printf("  htas-stats   - show current scheduler statistics\n");
-    printf("  sched TYPE   - switch scheduler (baseline, htas, dynamic)\n");
+    printf("  htas-infer   - show intents inferred by the DYNAMIC scheduler\n");
+    printf("  htas-slice [on|off] - adaptive slices per intent: switch rate vs run per switch\n");
+    printf("  trace [start|stop|dump] - binary scheduler trace (dump goes to serial)\n");
+    printf("  lockstat [on|off|reset] - per-lock acquisitions, contention and wait\n");
+    printf("  idle [reset] - idle states: usage, mispredictions and residency\n");
+    printf("  irqstat [reset] - interrupts-off time per IRQ, softirqs and IRQ threads\n");
+    printf("  wq [bench [KB]] - worker pool stats; checksum inline vs kparallel_for\n");
+    printf("  wl [start|stop|save NAME|load NAME] - record a workload (run/block phases)\n");
+    printf("  htas-replay  - replay the recorded workload under BASELINE, HTAS, DYNAMIC\n");
+    printf("  htas-sweep [MS] - parameter sweep, one CSV row per grid point on serial\n");
+    printf("  sched TYPE   - switch scheduler (baseline, htas, dynamic, fair)\n");
 }
 
 static void cmd_clear(void) { terminal_clear(); }
@@ -344,7 +360,7 @@ static void execute(char* line) {
         return;
     }
     if (!kstrcmp(line, "ls")) { fs_list_print(); return; }
-    if (!kstrcmp(line, "ps")) { extern void sched_ps(void); sched_ps(); return; }
+    if (!kstrcmp(line, "ps")) { process_ps(); return; }
     if (!kstrcmp(line, "spawn")) {
         extern int kthread_create(void (*fn)(void*), void*, const char*);
         void demo(void* _){ for(;;){ printf("[thr] tick\n"); for(volatile int i=0;i<1000000;i++); } }
@@ -383,13 +399,122 @@ static void execute(char* line) {
         extern void htas_print_stats(scheduler_stats_t*, const char*);
         extern scheduler_type_t htas_get_scheduler(void);
         scheduler_stats_t* stats = htas_get_stats();
-        const char* name = (htas_get_scheduler() == 0) ? "BASELINE" : "HTAS";
-        htas_print_stats(stats, name);
+        htas_print_stats(stats, htas_scheduler_name(htas_get_scheduler()));
+        return;
+    }
+    if (!kstrcmp(line, "trace")) {
+        if (!arg || !*arg) {
+            trace_status();
+        } else if (!kstrcmp(arg, "start")) {
+            trace_start();
+        } else if (!kstrcmp(arg, "stop")) {
+            trace_stop();
+        } else if (!kstrcmp(arg, "dump")) {
+            trace_dump_serial();
+        } else {
+            printf("usage: trace [start|stop|dump]\n");
+        }
+        return;
+    }
+    if (!kstrcmp(line, "lockstat")) {
+        if (!arg || !*arg) {
+            lockstat_print();
+        } else if (!kstrcmp(arg, "on")) {
+            lockstat_set(true);
+        } else if (!kstrcmp(arg, "off")) {
+            lockstat_set(false);
+        } else if (!kstrcmp(arg, "reset")) {
+            lockstat_reset();
+        } else {
+            printf("usage: lockstat [on|off|reset]\n");
+        }
+        return;
+    }
+    if (!kstrcmp(line, "idle")) {
+        if (!arg || !*arg) {
+            idle_print();
+        } else if (!kstrcmp(arg, "reset")) {
+            idle_reset();
+        } else {
+            printf("usage: idle [reset]\n");
+        }
+        return;
+    }
+    if (!kstrcmp(line, "irqstat")) {
+        if (!arg || !*arg) {
+            irq_stat_print();
+        } else if (!kstrcmp(arg, "reset")) {
+            irq_stat_reset();
+        } else {
+            printf("usage: irqstat [reset]\n");
+        }
+        return;
+    }
+    if (!kstrcmp(line, "wq")) {
+        char* kb = arg;
+        while (kb && *kb && *kb != ' ') kb++;
+        if (kb && *kb == ' ') { *kb++ = 0; while (*kb == ' ') kb++; }
+        uint32_t n = 0;
+        if (!arg || !*arg) {
+            workqueue_print();
+        } else if (!kstrcmp(arg, "bench") && (!*kb || parse_u32(kb, &n))) {
+            workqueue_bench(n);
+        } else {
+            printf("usage: wq [bench [KB]]\n");
+        }
+        return;
+    }
+    if (!kstrcmp(line, "wl")) {
+        char* name = arg;
+        while (name && *name && *name != ' ') name++;
+        if (name && *name == ' ') { *name++ = 0; while (*name == ' ') name++; }
+        if (!arg || !*arg) {
+            htas_wl_print();
+        } else if (!kstrcmp(arg, "start")) {
+            htas_wl_start();
+        } else if (!kstrcmp(arg, "stop")) {
+            htas_wl_stop();
+        } else if (!kstrcmp(arg, "save") && name && *name) {
+            htas_wl_save(name);
+        } else if (!kstrcmp(arg, "load") && name && *name) {
+            htas_wl_load(name);
+        } else {
+            printf("usage: wl [start|stop|save NAME|load NAME]\n");
+        }
+        return;
+    }
+    if (!kstrcmp(line, "htas-sweep")) {
+        uint32_t ms = 1000;
+        if (arg && *arg && (!parse_u32(arg, &ms) || ms == 0)) {
+            printf("usage: htas-sweep [MS]\n");
+            return;
+        }
+        htas_run_sweep(ms);
+        return;
+    }
+    if (!kstrcmp(line, "htas-replay")) {
+        htas_run_replay_benchmark(htas_wl_trace());
+        return;
+    }
+    if (!kstrcmp(line, "htas-slice")) {
+        if (!arg || !*arg) {
+            htas_slice_print();
+        } else if (!kstrcmp(arg, "on")) {
+            htas_slice_set_enabled(true);
+        } else if (!kstrcmp(arg, "off")) {
+            htas_slice_set_enabled(false);
+        } else {
+            printf("usage: htas-slice [on|off]\n");
+        }
+        return;
+    }
+    if (!kstrcmp(line, "htas-infer")) {
+        htas_print_inference();
         return;
     }
     if (!kstrcmp(line, "sched")) {
         if (!arg || !*arg) {
-            printf("usage: sched TYPE (baseline, htas, dynamic)\n");
+            printf("usage: sched TYPE (baseline, htas, dynamic, fair)\n");
             return;
         }
         extern void htas_set_scheduler(scheduler_type_t);
@@ -399,6 +524,8 @@ static void execute(char* line) {
             htas_set_scheduler(1); // SCHED_HTAS
         } else if (!kstrcmp(arg, "dynamic")) {
             htas_set_scheduler(2); // SCHED_DYNAMIC
+        } else if (!kstrcmp(arg, "fair")) {
+            htas_set_scheduler(SCHED_FAIR);
         } else {
             printf("unknown scheduler type: %s\n", arg);
         }
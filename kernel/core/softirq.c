@@ -0,0 +1,243 @@
+#include <kernel/softirq.h>
+#include <kernel/process.h>
+#include <kernel/sched.h>
+#include <kernel/lock.h>
+#include <kernel/tsc.h>
+#include <kernel/stdio.h>
+
+#define MAX_RESTART 10          /* Passes per exit; the rest waits for the next interrupt */
+#define IRQ_LINES   16
+
+static const char* s_names[NR_SOFTIRQS] = { "HI", "RCU", "TASKLET" };
+
+static softirq_fn s_vec[NR_SOFTIRQS];
+static uint32_t s_vec_runs[NR_SOFTIRQS];
+static volatile uint32_t s_pending;
+static bool s_in_softirq = false;
+static bool s_resched = false;  // A tick came in while softirqs ran
+
+/* Tasklets queued per list; only touched with interrupts off */
+typedef struct {
+    tasklet_t* head;
+    tasklet_t** tail;
+} tasklet_list_t;
+
+static tasklet_list_t s_tasklets = { 0, &s_tasklets.head };
+static tasklet_list_t s_tasklets_hi = { 0, &s_tasklets_hi.head };
+
+static irq_thread_t s_threads[IRQ_THREADS_MAX];
+static int s_nthreads = 0;
+
+// Interrupts-off time: the hard handler plus the scheduler it ends in
+static uint8_t s_irq;
+static uint64_t s_enter_stamp;
+static uint32_t s_irq_count[IRQ_LINES];
+static uint32_t s_irq_max_us[IRQ_LINES];
+static uint32_t s_sched_max_us;
+static uint32_t s_softirq_max_us;
+static uint32_t s_softirq_passes;
+static uint32_t s_deferred;     // Exits that left work for the next interrupt
+
+void open_softirq(int nr, softirq_fn fn) {
+    if (nr < 0 || nr >= NR_SOFTIRQS) return;
+    s_vec[nr] = fn;
+}
+
+void raise_softirq(int nr) {
+    __atomic_fetch_or(&s_pending, 1u << nr, __ATOMIC_SEQ_CST);
+}
+
+bool in_softirq(void) {
+    return s_in_softirq;
+}
+
+static void tasklet_queue(tasklet_list_t* list, tasklet_t* t, int nr) {
+    uint32_t flags = irq_save();
+    if (!t->scheduled) {
+        t->scheduled = true;
+        t->next = 0;
+        *list->tail = t;
+        list->tail = &t->next;
+        raise_softirq(nr);
+    }
+    irq_restore(flags);
+}
+
+void tasklet_schedule(tasklet_t* t) {
+    tasklet_queue(&s_tasklets, t, SOFTIRQ_TASKLET);
+}
+
+void tasklet_hi_schedule(tasklet_t* t) {
+    tasklet_queue(&s_tasklets_hi, t, SOFTIRQ_HI);
+}
+
+/* Detach the list, then run it with interrupts on. A tasklet may queue
+   itself again; it lands on the fresh list for the next pass. */
+static void tasklet_run(tasklet_list_t* list) {
+    uint32_t flags = irq_save();
+    tasklet_t* t = list->head;
+    list->head = 0;
+    list->tail = &list->head;
+    irq_restore(flags);
+
+    while (t) {
+        tasklet_t* next = t->next;
+        t->scheduled = false;
+        t->fn(t->data);
+        t = next;
+    }
+}
+
+static void tasklet_action(void) {
+    tasklet_run(&s_tasklets);
+}
+
+static void tasklet_hi_action(void) {
+    tasklet_run(&s_tasklets_hi);
+}
+
+void softirq_init(void) {
+    open_softirq(SOFTIRQ_HI, tasklet_hi_action);
+    open_softirq(SOFTIRQ_TASKLET, tasklet_action);
+}
+
+/* Called with interrupts off; returns with them off */
+static void do_softirq(void) {
+    uint64_t start = tsc_read();
+    s_in_softirq = true;
+
+    for (int pass = 0; s_pending && pass < MAX_RESTART; pass++) {
+        uint32_t pending = __atomic_exchange_n(&s_pending, 0, __ATOMIC_SEQ_CST);
+        __asm__ volatile("sti" ::: "memory");
+        for (int nr = 0; nr < NR_SOFTIRQS; nr++) {
+            if ((pending & (1u << nr)) && s_vec[nr]) {
+                s_vec[nr]();
+                s_vec_runs[nr]++;
+            }
+        }
+        __asm__ volatile("cli" ::: "memory");
+        s_softirq_passes++;
+    }
+    if (s_pending) {
+        s_deferred++;
+    }
+
+    s_in_softirq = false;
+    uint32_t us = (uint32_t)tsc_cycles_to_us(tsc_read() - start);
+    if (us > s_softirq_max_us) s_softirq_max_us = us;
+}
+
+void irq_enter(uint8_t irq) {
+    s_irq = irq;
+    s_enter_stamp = tsc_read();
+}
+
+struct registers* irq_exit(struct registers* regs, bool tick) {
+    uint64_t now = tsc_read();
+    if (s_irq < IRQ_LINES) {
+        uint32_t us = (uint32_t)tsc_cycles_to_us(now - s_enter_stamp);
+        s_irq_count[s_irq]++;
+        if (us > s_irq_max_us[s_irq]) s_irq_max_us[s_irq] = us;
+    }
+    if (tick) {
+        s_resched = true;
+    }
+
+    // Nested in a softirq pass: the outer exit runs the rest
+    if (s_in_softirq) {
+        return regs;
+    }
+    if (s_pending) {
+        do_softirq();
+    }
+
+    if (s_resched) {
+        s_resched = false;
+        now = tsc_read();
+        regs = process_schedule(regs);      // Kthreads and processes alike
+        uint32_t us = (uint32_t)tsc_cycles_to_us(tsc_read() - now);
+        if (us > s_sched_max_us) s_sched_max_us = us;
+    }
+    return regs;
+}
+
+/* Sleep until woken, run fn for every wakeup that came in meanwhile */
+static void irq_thread_main(void* arg) {
+    irq_thread_t* t = (irq_thread_t*)arg;
+    for (;;) {
+        uint32_t flags = wait_queue_lock(&t->wq);
+        if (!t->pending) {
+            wait_queue_sleep_locked(&t->wq, 0, flags);
+            continue;
+        }
+        t->pending = false;
+        wait_queue_unlock(&t->wq, flags);
+
+        t->fn();
+        t->runs++;
+    }
+}
+
+irq_thread_t* irq_thread_create(const char* name, void (*fn)(void), int priority) {
+    if (s_nthreads >= IRQ_THREADS_MAX) {
+        printf("irq: no room for thread %s\n", name);
+        return 0;
+    }
+
+    irq_thread_t* t = &s_threads[s_nthreads];
+    t->name = name;
+    t->fn = fn;
+    t->pending = false;
+    t->wakeups = t->runs = 0;
+    wait_queue_init(&t->wq, name);
+
+    t->pid = kthread_create(irq_thread_main, t, name);
+    if (t->pid < 0) {
+        printf("irq: cannot start thread %s\n", name);
+        return 0;
+    }
+    sched_set_priority(t->pid, priority);
+    s_nthreads++;
+    return t;
+}
+
+void irq_thread_wake(irq_thread_t* t) {
+    if (!t || t->pending) return;
+    t->pending = true;
+    t->wakeups++;
+    wait_queue_wake(&t->wq, 0, 1);
+}
+
+void irq_stat_print(void) {
+    printf("IRQ COUNT MAX-OFF (us)\n");
+    for (int i = 0; i < IRQ_LINES; i++) {
+        if (s_irq_count[i]) {
+            printf("%d %u %u\n", i, s_irq_count[i], s_irq_max_us[i]);
+        }
+    }
+    printf("scheduler at exit: max %u us\n", s_sched_max_us);
+    printf("softirq: %u passes, max %u us (interrupts on), %u exits deferred work\n",
+           s_softirq_passes, s_softirq_max_us, s_deferred);
+    for (int nr = 0; nr < NR_SOFTIRQS; nr++) {
+        printf("  %s %u\n", s_names[nr], s_vec_runs[nr]);
+    }
+    for (int i = 0; i < s_nthreads; i++) {
+        printf("thread %s (pid %d): %u wakeups, %u runs\n",
+               s_threads[i].name, s_threads[i].pid, s_threads[i].wakeups, s_threads[i].runs);
+    }
+}
+
+void irq_stat_reset(void) {
+    uint32_t flags = irq_save();
+    for (int i = 0; i < IRQ_LINES; i++) {
+        s_irq_count[i] = s_irq_max_us[i] = 0;
+    }
+    for (int nr = 0; nr < NR_SOFTIRQS; nr++) {
+        s_vec_runs[nr] = 0;
+    }
+    s_sched_max_us = s_softirq_max_us = s_softirq_passes = s_deferred = 0;
+    for (int i = 0; i < s_nthreads; i++) {
+        s_threads[i].wakeups = s_threads[i].runs = 0;
+    }
+    irq_restore(flags);
+}
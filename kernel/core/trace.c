@@ -0,0 +1,99 @@
+#include <kernel/trace.h>
+#include <kernel/tsc.h>
+#include <kernel/serial.h>
+#include <kernel/stdio.h>
+#include <string.h>
+
+_Static_assert((TRACE_RINGS & (TRACE_RINGS - 1)) == 0, "ring count power of two");
+_Static_assert(sizeof(trace_event_t) == 16, "trace event wire size");
+_Static_assert((TRACE_RING_EVENTS & (TRACE_RING_EVENTS - 1)) == 0, "ring size power of two");
+
+typedef struct {
+    volatile uint32_t head;             /* Total events ever reserved */
+    trace_event_t events[TRACE_RING_EVENTS];
+} trace_ring_t;
+
+static trace_ring_t s_rings[TRACE_RINGS];
+volatile bool g_trace_enabled = false;
+
+void trace_emit(uint8_t cpu, trace_type_t type, uint16_t pid, uint16_t arg0, uint16_t arg1) {
+    trace_ring_t* ring = &s_rings[cpu & (TRACE_RINGS - 1)];
+
+    uint32_t slot = __atomic_fetch_add(&ring->head, 1, __ATOMIC_RELAXED);
+    trace_event_t* ev = &ring->events[slot & (TRACE_RING_EVENTS - 1)];
+    ev->tsc = tsc_read();
+    ev->type = (uint8_t)type;
+    ev->cpu = cpu;
+    ev->pid = pid;
+    ev->arg0 = arg0;
+    ev->arg1 = arg1;
+}
+
+void trace_start(void) {
+    g_trace_enabled = false;
+    for (int i = 0; i < TRACE_RINGS; i++) {
+        s_rings[i].head = 0;
+    }
+    g_trace_enabled = true;
+    printf("trace: started (%d rings of %d events)\n", TRACE_RINGS, TRACE_RING_EVENTS);
+}
+
+void trace_stop(void) {
+    g_trace_enabled = false;
+    printf("trace: stopped\n");
+}
+
+static uint32_t ring_count(const trace_ring_t* ring) {
+    return (ring->head < TRACE_RING_EVENTS) ? ring->head : TRACE_RING_EVENTS;
+}
+
+static void put_bytes(const void* data, uint32_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    for (uint32_t i = 0; i < len; i++) {
+        serial_putbyte(p[i]);
+    }
+}
+
+static void put_u16(uint16_t v) { put_bytes(&v, sizeof(v)); }
+static void put_u32(uint32_t v) { put_bytes(&v, sizeof(v)); }
+
+void trace_dump_serial(void) {
+    bool was_enabled = g_trace_enabled;
+    g_trace_enabled = false;
+
+    put_bytes("HTRC", 4);
+    put_u16(TRACE_DUMP_VERSION);
+    put_u16(TRACE_RINGS);
+    put_u32(tsc_khz());
+
+    uint32_t total = 0;
+    for (int r = 0; r < TRACE_RINGS; r++) {
+        const trace_ring_t* ring = &s_rings[r];
+        uint32_t count = ring_count(ring);
+        uint32_t first = ring->head - count;     /* Oldest surviving event */
+
+        put_u16((uint16_t)r);
+        put_u16(0);
+        put_u32(count);
+        for (uint32_t i = 0; i < count; i++) {
+            put_bytes(&ring->events[(first + i) & (TRACE_RING_EVENTS - 1)],
+                      sizeof(trace_event_t));
+        }
+        total += count;
+    }
+
+    put_bytes("CRTH", 4);
+    printf("\ntrace: dumped %u events over serial\n", total);
+
+    g_trace_enabled = was_enabled;
+}
+
+void trace_status(void) {
+    printf("trace: %s\n", g_trace_enabled ? "running" : "stopped");
+    for (int r = 0; r < TRACE_RINGS; r++) {
+        uint32_t head = s_rings[r].head;
+        if (head == 0) continue;
+        printf("  ring %d: %u events recorded, %u dropped\n", r, head,
+               (head > TRACE_RING_EVENTS) ? head - TRACE_RING_EVENTS : 0);
+    }
+}
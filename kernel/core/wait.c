@@ -0,0 +1,89 @@
+#include <kernel/wait.h>
+#include <kernel/process.h>
+#include <kernel/idle.h>
+
+void wait_queue_init(wait_queue_t* wq, const char* name) {
+    spin_lock_init(&wq->lock, name);
+    wq->head = 0;
+}
+
+uint32_t wait_queue_lock(wait_queue_t* wq) {
+    return spin_lock_irqsave(&wq->lock);
+}
+
+void wait_queue_unlock(wait_queue_t* wq, uint32_t flags) {
+    spin_unlock_irqrestore(&wq->lock, flags);
+}
+
+static void unlink(wait_queue_t* wq, wait_entry_t* e) {
+    for (wait_entry_t** p = &wq->head; *p; p = &(*p)->next) {
+        if (*p == e) {
+            *p = e->next;
+            return;
+        }
+    }
+}
+
+/* Same sleep as mutex_lock(): BLOCKED with interrupts off until the halt,
+   then the next tick switches away until a waker makes us READY */
+void wait_queue_sleep_locked(wait_queue_t* wq, uint32_t key, uint32_t flags) {
+    process_t* self = process_current();
+    if (!self) {
+        wait_queue_unlock(wq, flags);
+        return;
+    }
+
+    wait_entry_t e = { .proc = self, .key = key, .woken = false, .next = 0 };
+    wait_entry_t** tail = &wq->head;
+    while (*tail) {
+        tail = &(*tail)->next;
+    }
+    *tail = &e;
+    self->wait_q = wq;
+    process_set_state(self, PROC_BLOCKED);
+    spin_unlock(&wq->lock);
+
+    do {
+        idle_wait();
+        __asm__ volatile("cli");
+    } while (!e.woken);
+    irq_restore(flags);
+}
+
+int wait_queue_wake(wait_queue_t* wq, uint32_t key, int n) {
+    uint32_t flags = wait_queue_lock(wq);
+    int woken = 0;
+    wait_entry_t** p = &wq->head;
+
+    while (*p && woken < n) {
+        wait_entry_t* e = *p;
+        if (e->key != key) {
+            p = &e->next;
+            continue;
+        }
+        *p = e->next;
+        e->proc->wait_q = 0;
+        e->woken = true;
+        if (e->proc->state == PROC_BLOCKED) {
+            process_set_state(e->proc, PROC_READY);
+        }
+        woken++;
+    }
+    wait_queue_unlock(wq, flags);
+    return woken;
+}
+
+void wait_queue_cancel(process_t* proc) {
+    wait_queue_t* wq = proc->wait_q;
+    if (!wq) return;
+
+    uint32_t flags = wait_queue_lock(wq);
+    for (wait_entry_t* e = wq->head; e; e = e->next) {
+        if (e->proc == proc) {
+            unlink(wq, e);
+            break;
+        }
+    }
+    proc->wait_q = 0;
+    wait_queue_unlock(wq, flags);
+}
@@ -0,0 +1,308 @@
+#include <kernel/workqueue.h>
+#include <kernel/wait.h>
+#include <kernel/lock.h>
+#include <kernel/sched.h>
+#include <kernel/process.h>
+#include <kernel/htas.h>
+#include <kernel/tsc.h>
+#include <kernel/stdio.h>
+
+/* Ring of work items. The owner pushes and pops at the bottom (newest
+   first, still warm in its cache); thieves take from the top (oldest,
+   usually the largest piece left). One CPU runs kernel code today, so a
+   short lock per operation costs less than the lock-free protocol. */
+typedef struct {
+    spinlock_t lock;
+    uint32_t top;                       // Oldest
+    uint32_t bottom;                    // One past the newest
+    work_t* slots[WQ_DEQUE_SIZE];
+} deque_t;
+
+typedef struct {
+    int pid;
+    deque_t deque;
+    uint32_t executed;
+    uint32_t stolen;                    // Taken from another worker's deque
+} worker_t;
+
+static worker_t s_workers[WQ_MAX_WORKERS];
+static int s_nworkers = 0;
+static uint32_t s_next = 0;             // Round-robin target for outside callers
+static uint32_t s_inline = 0;           // Ran in the caller: pool full or not started
+
+static wait_queue_t s_idle_wq;          // Workers with nothing to do
+static wait_queue_t s_done_wq;          // flush_work() and kparallel_for() waiters
+
+static bool deque_push(deque_t* d, work_t* w) {
+    uint32_t flags = spin_lock_irqsave(&d->lock);
+    bool ok = d->bottom - d->top < WQ_DEQUE_SIZE;
+    if (ok) {
+        d->slots[d->bottom % WQ_DEQUE_SIZE] = w;
+        d->bottom++;
+    }
+    spin_unlock_irqrestore(&d->lock, flags);
+    return ok;
+}
+
+static work_t* deque_pop(deque_t* d) {
+    work_t* w = 0;
+    uint32_t flags = spin_lock_irqsave(&d->lock);
+    if (d->bottom != d->top) {
+        d->bottom--;
+        w = d->slots[d->bottom % WQ_DEQUE_SIZE];
+    }
+    spin_unlock_irqrestore(&d->lock, flags);
+    return w;
+}
+
+static work_t* deque_steal(deque_t* d) {
+    work_t* w = 0;
+    uint32_t flags = spin_lock_irqsave(&d->lock);
+    if (d->bottom != d->top) {
+        w = d->slots[d->top % WQ_DEQUE_SIZE];
+        d->top++;
+    }
+    spin_unlock_irqrestore(&d->lock, flags);
+    return w;
+}
+
+static bool deque_empty(deque_t* d) {
+    return d->bottom == d->top;
+}
+
+/* The worker the calling kthread is, -1 for everyone else */
+static int current_worker(void) {
+    int pid = process_get_current_pid();
+    for (int i = 0; i < s_nworkers; i++) {
+        if (s_workers[i].pid == pid) return i;
+    }
+    return -1;
+}
+
+/* Own deque first, then steal starting at the next worker over */
+static work_t* take(int self) {
+    if (self >= 0) {
+        work_t* w = deque_pop(&s_workers[self].deque);
+        if (w) return w;
+    }
+    int start = (self >= 0) ? self + 1 : 0;
+    for (int i = 0; i < s_nworkers; i++) {
+        int victim = (start + i) % s_nworkers;
+        if (victim == self) continue;
+        work_t* w = deque_steal(&s_workers[victim].deque);
+        if (w) {
+            if (self >= 0) s_workers[self].stolen++;
+            return w;
+        }
+    }
+    return 0;
+}
+
+/* pending drops before the wakeup: once a waiter sees it clear, the item
+   (often on the waiter's stack) is not touched again, only its address */
+static void run(work_t* w, int self) {
+    w->fn(w);
+    if (self >= 0) s_workers[self].executed++;
+    __atomic_store_n(&w->pending, false, __ATOMIC_RELEASE);
+    wait_queue_wake(&s_done_wq, (uint32_t)(uintptr_t)w, MAX_PROCESSES);
+}
+
+static bool any_work(void) {
+    for (int i = 0; i < s_nworkers; i++) {
+        if (!deque_empty(&s_workers[i].deque)) return true;
+    }
+    return false;
+}
+
+static void worker_main(void* arg) {
+    int self = (int)(uintptr_t)arg;
+    for (;;) {
+        work_t* w = take(self);
+        if (w) {
+            run(w, self);
+            continue;
+        }
+
+        // A push after this check wakes us: it needs the queue lock we hold
+        uint32_t flags = wait_queue_lock(&s_idle_wq);
+        if (any_work()) {
+            wait_queue_unlock(&s_idle_wq, flags);
+        } else {
+            wait_queue_sleep_locked(&s_idle_wq, 0, flags);
+        }
+    }
+}
+
+void workqueue_init(void) {
+    wait_queue_init(&s_idle_wq, "wq-idle");
+    wait_queue_init(&s_done_wq, "wq-done");
+
+    int n = g_num_cpus < WQ_MAX_WORKERS ? g_num_cpus : WQ_MAX_WORKERS;
+    for (int i = 0; i < n; i++) {
+        worker_t* worker = &s_workers[s_nworkers];
+        spin_lock_init(&worker->deque.lock, 0);
+        worker->deque.top = worker->deque.bottom = 0;
+        worker->executed = worker->stolen = 0;
+
+        char name[] = "kworker/0";
+        name[8] = (char)('0' + i);
+        worker->pid = kthread_create(worker_main, (void*)(uintptr_t)s_nworkers, name);
+        if (worker->pid < 0) {
+            printf("workqueue: cannot start worker %d\n", i);
+            break;
+        }
+        // Priority sets the profile, which resets affinity: pin afterwards
+        sched_set_priority(worker->pid, SCHED_PRIORITY_INTERACTIVE);
+        sys_sched_set_affinity((uint32_t)worker->pid, CPUMASK_BIT(i));
+        s_nworkers++;
+    }
+    printf("workqueue: %d workers\n", s_nworkers);
+}
+
+int workqueue_workers(void) {
+    return s_nworkers;
+}
+
+/* Onto the caller's own deque if it is a worker, else the next in turn */
+static bool push(work_t* w) {
+    if (s_nworkers == 0) return false;
+
+    int self = current_worker();
+    int target = (self >= 0) ? self : (int)(s_next++ % s_nworkers);
+    for (int i = 0; i < s_nworkers; i++) {
+        if (deque_push(&s_workers[(target + i) % s_nworkers].deque, w)) return true;
+    }
+    return false;
+}
+
+bool queue_work(work_t* work) {
+    uint32_t flags = irq_save();
+    if (work->pending) {
+        irq_restore(flags);
+        return false;
+    }
+    work->pending = true;
+    irq_restore(flags);
+
+    if (!push(work)) {
+        s_inline++;
+        run(work, -1);
+        return true;
+    }
+    wait_queue_wake(&s_idle_wq, 0, 1);
+    return true;
+}
+
+void flush_work(work_t* work) {
+    while (__atomic_load_n(&work->pending, __ATOMIC_ACQUIRE)) {
+        uint32_t flags = wait_queue_lock(&s_done_wq);
+        if (work->pending) {
+            wait_queue_sleep_locked(&s_done_wq, (uint32_t)(uintptr_t)work, flags);
+        } else {
+            wait_queue_unlock(&s_done_wq, flags);
+        }
+    }
+}
+
+typedef struct {
+    work_t work;                        // First: the work_t* is the chunk
+    uint32_t begin, end;
+    kpar_fn fn;
+    void* arg;
+} kpar_chunk_t;
+
+static void kpar_chunk_run(work_t* work) {
+    kpar_chunk_t* c = (kpar_chunk_t*)work;
+    c->fn(c->begin, c->end, c->arg);
+}
+
+void kparallel_for(uint32_t begin, uint32_t end, uint32_t grain, kpar_fn fn, void* arg) {
+    if (end <= begin) return;
+    if (grain == 0) grain = 1;
+
+    // A few chunks per worker so thieves find something when loads differ
+    uint32_t len = end - begin;
+    uint32_t chunks = len / grain;
+    uint32_t cap = (uint32_t)s_nworkers * 4;
+    if (cap > KPAR_MAX_CHUNKS) cap = KPAR_MAX_CHUNKS;
+    if (chunks > cap) chunks = cap;
+    if (chunks <= 1) {
+        fn(begin, end, arg);
+        return;
+    }
+
+    kpar_chunk_t chunk[KPAR_MAX_CHUNKS];
+    uint32_t step = len / chunks, extra = len % chunks;
+    uint32_t at = begin;
+    for (uint32_t i = 0; i < chunks; i++) {
+        uint32_t n = step + (i < extra ? 1 : 0);
+        chunk[i] = (kpar_chunk_t){ .work = WORK_INIT(kpar_chunk_run), .begin = at,
+                                   .end = at + n, .fn = fn, .arg = arg };
+        at += n;
+    }
+
+    // Spread over the deques; what does not fit runs here
+    int self = current_worker();
+    for (uint32_t i = 0; i < chunks; i++) {
+        chunk[i].work.pending = true;
+        deque_t* d = &s_workers[(self >= 0 ? (uint32_t)self + i : i) % s_nworkers].deque;
+        if (!deque_push(d, &chunk[i].work)) {
+            s_inline++;
+            run(&chunk[i].work, self);
+        }
+    }
+    wait_queue_wake(&s_idle_wq, 0, s_nworkers);
+
+    // Help until nothing is left to take, then wait for the chunks in flight
+    for (work_t* w; (w = take(self)) != 0;) {
+        run(w, self);
+    }
+    for (uint32_t i = 0; i < chunks; i++) {
+        flush_work(&chunk[i].work);
+    }
+}
+
+void workqueue_print(void) {
+    printf("workqueue: %d workers, %u items run inline\n", s_nworkers, s_inline);
+    printf("WORKER PID EXECUTED STOLEN QUEUED\n");
+    for (int i = 0; i < s_nworkers; i++) {
+        worker_t* w = &s_workers[i];
+        printf("%d %d %u %u %u\n", i, w->pid, w->executed, w->stolen,
+               w->deque.bottom - w->deque.top);
+    }
+}
+
+/* Checksum kb of the kernel image inline, then through kparallel_for */
+typedef struct {
+    const uint8_t* base;
+    volatile uint32_t sum;
+} bench_t;
+
+static void bench_sum(uint32_t begin, uint32_t end, void* arg) {
+    bench_t* b = (bench_t*)arg;
+    uint32_t sum = 0;
+    for (uint32_t i = begin; i < end; i++) {
+        sum += b->base[i] * (i | 1);
+    }
+    __atomic_fetch_add(&b->sum, sum, __ATOMIC_RELAXED);
+}
+
+void workqueue_bench(uint32_t kb) {
+    extern uint32_t kernel_phys_start, kernel_phys_end;
+    uint32_t image = (uint32_t)&kernel_phys_end - (uint32_t)&kernel_phys_start;
+    uint32_t len = kb * 1024;
+    if (len == 0 || len > image) len = image;
+
+    bench_t b = { .base = (const uint8_t*)((uint32_t)&kernel_phys_start + 0xC0000000u) };
+    uint64_t t0 = tsc_read();
+    bench_sum(0, len, &b);
+    uint32_t serial = b.sum;
+    uint64_t t1 = tsc_read();
+    b.sum = 0;
+    kparallel_for(0, len, 4096, bench_sum, &b);
+    uint64_t t2 = tsc_read();
+
+    printf("wq bench: %u KB, inline %u us, parallel %u us on %d workers, %s\n", len / 1024,
+           (uint32_t)tsc_cycles_to_us(t1 - t0), (uint32_t)tsc_cycles_to_us(t2 - t1),
+           s_nworkers, b.sum == serial ? "sums match" : "SUM MISMATCH");
+}
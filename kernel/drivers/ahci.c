@@ -3,6 +3,7 @@
 #include <kernel/stdio.h>
 #include <kernel/pmm.h>
 #include <kernel/vmm.h>
+#include <kernel/lock.h>
 #include <string.h>
 #include <stdint.h>
 
@@ -36,25 +37,6 @@
 #define AHCI_VIRT_BASE 0xFEC00000u
 #define AHCI_VIRT_SIZE (0x1000u * 4u)
 
-/* Simple spinlock for serializing AHCI operations */
-typedef struct {
-    volatile int locked;
-} spinlock_t;
-
-static inline void spinlock_init(spinlock_t* lock) {
-    lock->locked = 0;
-}
-
-static inline void spinlock_acquire(spinlock_t* lock) {
-    while (__sync_lock_test_and_set(&lock->locked, 1)) {
-        while (lock->locked) { /* spin */ }
-    }
-}
-
-static inline void spinlock_release(spinlock_t* lock) {
-    __sync_lock_release(&lock->locked);
-}
-
 typedef volatile struct {
     uint32_t clb;
     uint32_t clbu;
@@ -383,7 +365,7 @@ static int issue_cmd(hba_port_t* port, uint32_t lba, uint8_t count, int write, v
 }
 
 int ahci_init(void) {
-    spinlock_init(&g_ahci_lock);
+    spin_lock_init(&g_ahci_lock, "ahci");
     
     struct pci_device dev;
     if (pci_find_class(AHCI_CLASS_CODE, AHCI_SUBCLASS, 0xFF, &dev) != 0) {
@@ -477,7 +459,7 @@ static int ahci_io(uint32_t lba, uint8_t count, void* buffer, int write) {
     if (!g_ahci_ready || !g_active_port) return -1;
     
     /* CRITICAL: Acquire lock to prevent concurrent access to shared DMA buffer */
-    spinlock_acquire(&g_ahci_lock);
+    spin_lock(&g_ahci_lock);
     
     int result = 0;
     uint8_t remaining = count;
@@ -493,7 +475,7 @@ static int ahci_io(uint32_t lba, uint8_t count, void* buffer, int write) {
         remaining -= n;
     }
     
-    spinlock_release(&g_ahci_lock);
+    spin_unlock(&g_ahci_lock);
     return result;
 }
 
@@ -2,6 +2,8 @@
 #include <kernel/stdio.h>
 #include <kernel/ports.h>
 #include <kernel/serial.h>
+#include <kernel/softirq.h>
+#include <kernel/lock.h>
 
 #define KBD_BUF_SIZE 128
 static volatile uint16_t buf[KBD_BUF_SIZE];
@@ -27,6 +29,14 @@ static const char keymap_shift[128] = {
     '*', 0,' ',
 };
 
+/* Raw PS/2 scancodes from the interrupt handler, decoded by a tasklet */
+#define RAW_SIZE 32
+static volatile uint8_t raw[RAW_SIZE];
+static volatile uint8_t raw_head = 0, raw_tail = 0;
+
+static void decode_raw(uintptr_t data);
+static tasklet_t s_decode = TASKLET_INIT(decode_raw, 0);
+
 static inline int buf_empty(void){ return head==tail; }
 static inline int buf_full(void){ return (uint8_t)(head+1)==tail; }
 
@@ -40,7 +50,7 @@ void keyboard_init(void) {
     outb(0x60, 0x45);
 }
 
-void keyboard_on_scancode(uint8_t sc) {
+static void decode(uint8_t sc) {
     if (sc == 0xE0) { 
         e0 = 1;
         return;
@@ -103,6 +113,31 @@ void keyboard_on_scancode(uint8_t sc) {
     if (!buf_full()) { buf[head] = (uint16_t)(uint8_t)ch; head = (uint8_t)(head+1); }
 }
 
+/* PS/2 and USB (its poll thread) both feed the decoder */
+void keyboard_on_scancode(uint8_t sc) {
+    uint32_t flags = irq_save();
+    decode(sc);
+    irq_restore(flags);
+}
+
+static void decode_raw(uintptr_t data) {
+    (void)data;
+    while (raw_tail != raw_head) {
+        uint8_t sc = raw[raw_tail % RAW_SIZE];
+        raw_tail++;
+        keyboard_on_scancode(sc);
+    }
+}
+
+void keyboard_irq(void) {
+    uint8_t sc = inb(0x60);
+    if ((uint8_t)(raw_head - raw_tail) < RAW_SIZE) {
+        raw[raw_head % RAW_SIZE] = sc;
+        raw_head++;
+    }
+    tasklet_schedule(&s_decode);
+}
+
 int kbd_getch(void) {
     if (buf_empty()) return -1;
     uint16_t v = buf[tail]; tail = (uint8_t)(tail+1);
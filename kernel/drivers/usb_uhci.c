@@ -3,6 +3,8 @@
 #include <kernel/stdio.h>
 #include <kernel/pmm.h>
 #include <kernel/vmm.h>
+#include <kernel/softirq.h>
+#include <kernel/sched.h>
 #include <string.h>
 
 /* UHCI (USB 1.1) Host Controller Driver */
@@ -98,6 +100,7 @@ typedef struct uhci_qh {
 static uint16_t g_uhci_iobase = 0;
 static uint32_t* g_frame_list = NULL;
 static int g_uhci_ready = 0;
+static irq_thread_t* s_poll_thread = 0;   /* Runs usb_poll() */
 
 /* Per-device state */
 #define MAX_USB_DEVICES 8
@@ -457,9 +460,9 @@ void usb_poll(void) {
     
     /* Check USB status */
     uint16_t status = uhci_read16(UHCI_USBSTS);
-    if (status & UHCI_STS_USBINT) {
+    if (status & (UHCI_STS_USBINT | UHCI_STS_ERROR)) {
         /* Clear interrupt */
-        uhci_write16(UHCI_USBSTS, UHCI_STS_USBINT);
+        uhci_write16(UHCI_USBSTS, status & (UHCI_STS_USBINT | UHCI_STS_ERROR));
     }
     
     /* Poll all active devices */
@@ -495,3 +498,21 @@ void usb_poll(void) {
         }
     }
 }
+
+/* Interrupt TDs are queued with IOC, so a finished or failed transfer shows up
+   in USBSTS; the tick reads that one register instead of walking devices */
+void usb_tick(void) {
+    if (!g_uhci_ready) return;
+    if (!s_poll_thread) {
+        usb_poll();
+        return;
+    }
+    if (uhci_read16(UHCI_USBSTS) & (UHCI_STS_USBINT | UHCI_STS_ERROR)) {
+        irq_thread_wake(s_poll_thread);
+    }
+}
+
+void usb_start_thread(void) {
+    if (!g_uhci_ready) return;
+    s_poll_thread = irq_thread_create("usb", usb_poll, SCHED_PRIORITY_REALTIME);
+}
@@ -0,0 +1,114 @@
+#ifndef _KERNEL_ACPI_H
+#define _KERNEL_ACPI_H
+
+#include <stdint.h>
+
+/* Read-only access to the ACPI tables. acpi_init() finds the RSDP in the
+   EBDA or BIOS area; tables are mapped on demand into a fixed kernel
+   window, so pointers stay valid for the life of the kernel. */
+
+typedef struct {
+    char     signature[4];
+    uint32_t length;                    /* Including this header */
+    uint8_t  revision;
+    uint8_t  checksum;
+    char     oem_id[6];
+    char     oem_table_id[8];
+    uint32_t oem_revision;
+    uint32_t creator_id;
+    uint32_t creator_revision;
+} __attribute__((packed)) acpi_sdt_header_t;
+
+/* MADT (signature "APIC") */
+typedef struct {
+    acpi_sdt_header_t header;
+    uint32_t lapic_addr;
+    uint32_t flags;
+} __attribute__((packed)) acpi_madt_t;
+
+typedef struct {
+    uint8_t type;
+    uint8_t length;
+} __attribute__((packed)) acpi_subtable_t;
+
+#define MADT_LOCAL_APIC    0
+#define MADT_LOCAL_X2APIC  9
+
+#define MADT_CPU_ENABLED         0x1
+#define MADT_CPU_ONLINE_CAPABLE  0x2
+
+typedef struct {
+    acpi_subtable_t hdr;
+    uint8_t  acpi_id;
+    uint8_t  apic_id;
+    uint32_t flags;
+} __attribute__((packed)) madt_local_apic_t;
+
+typedef struct {
+    acpi_subtable_t hdr;
+    uint16_t reserved;
+    uint32_t x2apic_id;
+    uint32_t flags;
+    uint32_t acpi_uid;
+} __attribute__((packed)) madt_local_x2apic_t;
+
+/* SRAT (signature "SRAT"): which proximity domain each CPU and memory
+   range belongs to */
+typedef struct {
+    acpi_sdt_header_t header;
+    uint32_t reserved1;
+    uint64_t reserved2;
+} __attribute__((packed)) acpi_srat_t;
+
+#define SRAT_CPU_AFFINITY     0
+#define SRAT_MEMORY_AFFINITY  1
+#define SRAT_X2APIC_AFFINITY  2
+
+#define SRAT_ENABLED          0x1
+
+typedef struct {
+    acpi_subtable_t hdr;
+    uint8_t  domain_lo;                 /* Proximity domain bits 7:0 */
+    uint8_t  apic_id;
+    uint32_t flags;
+    uint8_t  sapic_eid;
+    uint8_t  domain_hi[3];              /* Proximity domain bits 31:8 */
+    uint32_t clock_domain;
+} __attribute__((packed)) srat_cpu_affinity_t;
+
+typedef struct {
+    acpi_subtable_t hdr;
+    uint32_t domain;
+    uint16_t reserved1;
+    uint64_t base;
+    uint64_t length;
+    uint32_t reserved2;
+    uint32_t flags;
+    uint64_t reserved3;
+} __attribute__((packed)) srat_memory_affinity_t;
+
+typedef struct {
+    acpi_subtable_t hdr;
+    uint16_t reserved1;
+    uint32_t domain;
+    uint32_t x2apic_id;
+    uint32_t flags;
+    uint32_t clock_domain;
+    uint32_t reserved2;
+} __attribute__((packed)) srat_x2apic_affinity_t;
+
+/* SLIT (signature "SLIT"): localities x localities matrix of relative
+   distances, 10 = local */
+typedef struct {
+    acpi_sdt_header_t header;
+    uint64_t localities;
+    uint8_t  distance[];
+} __attribute__((packed)) acpi_slit_t;
+
+/* Returns 0 if an RSDP with a valid root table was found */
+int acpi_init(void);
+
+/* First table with this signature (checksum verified), or NULL */
+const acpi_sdt_header_t* acpi_find_table(const char* signature);
+
+#endif
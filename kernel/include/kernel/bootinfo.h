@@ -8,4 +8,10 @@ int  bootinfo_first_module(void** start, uint32_t* size);
 int  bootinfo_module_count(void);
 int  bootinfo_get_module(int index, void** start, uint32_t* size, const char** name);
 
+/* Kernel command line ("" if the loader gave none) */
+const char* bootinfo_cmdline(void);
+/* Copy the value of a "key=value" command line word into out (NUL
+   terminated, truncated to len); returns 0 if present, -1 if not */
+int  bootinfo_param(const char* key, char* out, unsigned len);
+
 #endif
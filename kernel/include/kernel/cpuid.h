@@ -0,0 +1,23 @@
+#ifndef _KERNEL_CPUID_H
+#define _KERNEL_CPUID_H
+
+#include <stdint.h>
+
+typedef struct {
+    uint32_t eax, ebx, ecx, edx;
+} cpuid_regs_t;
+
+static inline cpuid_regs_t cpuid(uint32_t leaf, uint32_t subleaf) {
+    cpuid_regs_t r;
+    __asm__ volatile("cpuid"
+                     : "=a"(r.eax), "=b"(r.ebx), "=c"(r.ecx), "=d"(r.edx)
+                     : "a"(leaf), "c"(subleaf));
+    return r;
+}
+
+/* Highest standard leaf */
+static inline uint32_t cpuid_max_leaf(void) {
+    return cpuid(0, 0).eax;
+}
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef _KERNEL_FUTEX_H
+#define _KERNEL_FUTEX_H
+
+#include <stdint.h>
+
+/* Futexes: sleep on a user word until another thread wakes that word.
+ * Waiters are keyed by the physical address of the word (frame | offset),
+ * so every mapping of the same memory meets on one key, and hashed into
+ * a fixed table of wait queues. The value check and the enqueue happen
+ * under the bucket lock, so a wake between them cannot be lost.
+ */
+
+void futex_init(void);
+
+/* Sleep while *uaddr == val. 0 once woken, -1 when the value differed or
+   the address is not a mapped, aligned user word. */
+int futex_wait(uint32_t uaddr, uint32_t val);
+
+/* Wake up to n waiters on uaddr; returns how many, or -1 */
+int futex_wake(uint32_t uaddr, int n);
+
+#endif
@@ -2,6 +2,7 @@
 #define _KERNEL_GDT_H
 
 #include <stdint.h>
+#include <stdbool.h>
 
 /* GDT Entry Structure (8 bytes) */
 struct GdtEntry {
@@ -24,6 +25,7 @@ struct GdtPtr {
 #define KERNEL_DS 0x10
 #define USER_CS   0x1B
 #define USER_DS   0x23
+#define USER_TLS  0x33      /* gs in user mode: base is the thread's TLS block */
 
 /* 32-bit TSS structure */
 struct TssEntry {
@@ -42,6 +44,15 @@ struct TssEntry {
 
 /* Set esp0 for ring transitions */
 void tss_set_kernel_stack(uint32_t esp0);
+uint32_t tss_get_kernel_stack(void);
+
+/* Rebase the TLS segment; takes effect at the next load of gs (every
+   return to user mode reloads it) */
+void gdt_set_tls(uint32_t base);
+
+/* Fast system calls: program the SYSENTER MSRs if the CPU has them */
+bool sysenter_supported(void);
+bool sysenter_init(void);
 
 /**
  * @brief Initializes and loads the GDT.
@@ -12,16 +12,18 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <kernel/rbtree.h>
 
 /* Forward declaration to avoid circular dependency */
 struct process;
+struct proc_times;
 
 /* ============================================================================
  * SIMULATED HARDWARE TOPOLOGY
  * ============================================================================ */
 
-#define NUM_CPUS 4
-#define NUM_NUMA_NODES 2
+#define HTAS_MAX_CPUS 64
+#define HTAS_MAX_NUMA_NODES 8
 
 typedef enum {
     CPU_TYPE_PCORE,  // Performance core (fast)
@@ -33,26 +35,59 @@ typedef struct {
     cpu_type_t type;
     uint8_t numa_node;
     bool online;
+    uint32_t apic_id;                // From the MADT (0 when simulated)
 } cpu_info_t;
 
-/* Hard-coded topology map:
- * CPU 0: P-Core, NUMA Node 0
- * CPU 1: P-Core, NUMA Node 0
- * CPU 2: E-Core, NUMA Node 1
- * CPU 3: E-Core, NUMA Node 1
+/* One bit per CPU id */
+typedef uint64_t cpumask_t;
+#define CPUMASK_BIT(cpu) ((cpumask_t)1 << (cpu))
+
+/* Topology, built at boot by htas_topology_init():
+ *   - CPUs from the ACPI MADT (enabled or online-capable local APICs)
+ *   - core type from CPUID leaf 0x1A on hybrid parts (boot CPU only; the
+ *     others cannot be queried without running on them and count as P)
+ *   - or the htas.topo= boot parameter, which overrides both, e.g.
+ *     htas.topo=PP:EE  -> CPUs 0,1 P-cores on node 0, CPUs 2,3 E-cores on node 1
+ * NUMA nodes of discovered CPUs are filled in by htas_numa_init().
  */
-extern cpu_info_t g_cpu_topology[NUM_CPUS];
-
-/* NUMA memory regions (simulated)
- * Node 0: 0x00000000 - 0x07FFFFFF (128MB)
- * Node 1: 0x08000000 - 0x0FFFFFFF (128MB)
+extern cpu_info_t g_cpu_topology[HTAS_MAX_CPUS];
+extern int g_num_cpus;
+
+void htas_topology_init(void);
+void htas_topology_print(void);
+bool htas_topology_is_override(void);   // Layout came from htas.topo=
+
+/* NUMA layout, built at boot by htas_numa_init():
+ *   - memory ranges and CPU nodes from the ACPI SRAT, distances from the SLIT
+ *   - without an SRAT, each node of the CPU topology gets a simulated
+ *     128MB range (node 0 at 0, node 1 at 128MB, ...)
+ * Distances use the SLIT scale: 10 is local, 20 is twice as far.
  */
+#define HTAS_MAX_NUMA_REGIONS 32
+#define NUMA_LOCAL_DISTANCE   10
+#define NUMA_REMOTE_DISTANCE  20         // Used when there is no SLIT
+
 typedef struct {
     uint32_t base;
     uint32_t size;
+    uint8_t node;
 } numa_region_t;
 
-extern numa_region_t g_numa_regions[NUM_NUMA_NODES];
+/* Sorted by base, non-overlapping */
+extern numa_region_t g_numa_regions[HTAS_MAX_NUMA_REGIONS];
+extern int g_num_numa_regions;
+extern int g_num_numa_nodes;
+
+void htas_numa_init(void);
+void htas_numa_print(void);
+
+/* SLIT distance between two nodes */
+uint8_t htas_numa_distance(uint8_t from, uint8_t to);
+
+/* Placement score for memory on mem_node and a CPU on cpu_node: `local`
+ * when the distance is local, scaled linearly with distance so that
+ * NUMA_REMOTE_DISTANCE scores `remote` */
+int htas_numa_score(uint8_t mem_node, uint8_t cpu_node, int local, int remote);
 
 /* ============================================================================
  * TASK INTENT PROFILES
@@ -69,6 +104,13 @@ typedef struct {
     task_intent_t intent;
     void* primary_data_region;  // For NUMA-awareness
     uint32_t data_size;          // Size of data region
+
+    /* Deadline reservation for LOW_LATENCY tasks (all zero = none):
+     * dl_runtime_us of CPU every dl_period_us, finished within
+     * dl_deadline_us of each period start. */
+    uint32_t dl_runtime_us;
+    uint32_t dl_deadline_us;
+    uint32_t dl_period_us;
 } task_profile_t;
 
 /* ============================================================================
@@ -79,6 +121,7 @@ typedef enum {
     SCHED_BASELINE,   // Round-robin, topology-unaware
     SCHED_HTAS,       // Hint-based topology-aware
     SCHED_DYNAMIC,    // Dynamic scheduler
+    SCHED_FAIR,       // Weighted fair-share (smallest vruntime first)
 } scheduler_type_t;
 
 /* ============================================================================
@@ -87,7 +130,7 @@ typedef enum {
 
 typedef struct htas_task_info {
     task_profile_t profile;
-    uint32_t cpu_affinity_mask;     // Bitmask of allowed CPUs
+    cpumask_t cpu_affinity_mask;    // Bitmask of allowed CPUs
     int priority_boost;              // For LOW_LATENCY tasks
     uint8_t preferred_numa_node;    // Calculated from data_region
     
@@ -101,17 +144,93 @@ typedef struct htas_task_info {
     uint64_t numa_penalties;         // Cross-NUMA access penalties
 } htas_task_info_t;
 
+/* Scheduler bookkeeping embedded in every process, hinted or not
+ * (htas_info above only exists once a profile has been set). */
+typedef struct htas_entity {
+    struct rb_node run_node;         // FAIR run queue linkage, keyed on vruntime
+    bool on_rq;                      // Linked into the FAIR run queue
+    uint64_t vruntime;               // Runtime scaled by 1024/weight (us)
+
+    // Deadline (EDF/CBS) state, used once a reservation is admitted
+    struct rb_node dl_node;          // Deadline run queue, keyed on dl_abs_deadline_us
+    bool dl_admitted;                // Bandwidth reserved by admission control
+    bool dl_on_rq;
+    bool dl_throttled;               // Budget exhausted until dl_replenish_us
+    int64_t dl_budget_us;            // Runtime left in the current period
+    uint64_t dl_abs_deadline_us;
+    uint64_t dl_replenish_us;
+    uint64_t dl_misses;
+
+    // DYNAMIC inference (htas_dynamic.c): bit 0 of each history is the
+    // most recent tick, so popcount over the word is a DYN_WINDOW_TICKS window
+    uint32_t run_history;            // Ticks spent on the CPU
+    uint32_t demand_history;         // Ticks runnable (on CPU or waiting for it)
+    uint32_t io_history;             // Ticks blocked waiting for I/O
+    uint32_t observed_ticks;         // Ticks since creation, saturating
+    uint32_t burst_ticks;            // CPU ticks since the last voluntary block
+    uint32_t avg_burst_x8;           // EWMA of CPU burst length, ticks * 8
+    uint32_t nvcsw;                  // Voluntary switches (blocked, exited)
+    uint32_t nivcsw;                 // Involuntary switches (preempted)
+    uint32_t wait_ticks;             // Runnable but not picked (DYNAMIC aging)
+    uint32_t slice_left;             // Ticks left of the HTAS slice (htas_slice.c)
+    bool yielded;                    // sched_yield() gives up the rest of the slice
+    uint32_t numa_hits[HTAS_MAX_NUMA_NODES];
+    bool io_waiting;                 // Inside a blocking read/wait
+    task_intent_t inferred_intent;
+
+    // CPU time accounting (htas_acct.c), all in TSC cycles
+    bool acct_on_cpu;                // An on-CPU interval is open at acct_stamp
+    bool acct_in_kernel;             // Inside a system call
+    uint8_t acct_cpu;                // Simulated CPU the interval runs on
+    uint64_t acct_stamp;
+    uint64_t ready_stamp;            // Became runnable but not running (0 = not waiting)
+    uint64_t wakeup_stamp;           // Last READY transition, until it first runs
+    uint64_t io_stamp;               // Entered an I/O wait
+    uint64_t user_cycles;
+    uint64_t sys_cycles;
+    uint64_t pcore_cycles;
+    uint64_t ecore_cycles;
+    uint64_t wait_cycles;            // Runnable, waiting for a CPU
+    uint64_t iowait_cycles;          // Blocked in read/wait
+
+    // Workload recording (htas_workload.c)
+    int wl_slot;                     // Recorder task index, -1 when not recorded
+    uint64_t wl_run_base;            // user+sys cycles at the start of this phase
+    uint64_t wl_block_stamp;         // TSC when the current block began
+} htas_entity_t;
+
 /* ============================================================================
  * SIMULATION PARAMETERS
  * ============================================================================ */
 
 #define ECORE_SLOWDOWN_FACTOR 2      // E-cores run at 50% speed
-#define NUMA_PENALTY_CYCLES 100      // Cross-NUMA access penalty
+#define NUMA_PENALTY_CYCLES 100      // Per 10 units of distance beyond local
 #define LOW_LATENCY_PRIORITY_BOOST 10
 
 #define AGING_THRESHOLD 100          // Ticks before aging boost
 #define AGING_PRIORITY_BOOST 5       // Boost amount for aged tasks
 
+/* FAIR weights: a task's vruntime advances by runtime * 1024 / weight,
+ * so CPU share under contention is proportional to weight. */
+#define FAIR_WEIGHT_NICE0        1024
+#define FAIR_WEIGHT_PERFORMANCE  2048
+#define FAIR_WEIGHT_EFFICIENCY   512
+#define FAIR_WEIGHT_LOW_LATENCY  1536
+#define FAIR_WAKEUP_CREDIT_US    5000   // Max vruntime credit for a waking task
+
+/* Deadline admission: total runtime/period over all reservations may not
+ * exceed this fraction (per mille) of the P-core capacity. */
+#define DL_MAX_UTIL_PERMILLE     950
+
+/* DYNAMIC classification thresholds, over the last DYN_WINDOW_TICKS ticks */
+#define DYN_WINDOW_TICKS         32
+#define DYN_PERF_ENTER_TICKS     24     // Runnable >= 75% of the window
+#define DYN_PERF_LEAVE_TICKS     16     // ...stays PERFORMANCE until < 50%
+#define DYN_EFFI_MAX_TICKS       8      // Runnable <= 25%, no I/O
+#define DYN_LOWLAT_MIN_IO_TICKS  2      // Blocks on I/O in the window...
+#define DYN_LOWLAT_MAX_BURST     3      // ...with short bursts (ticks)
+#define DYN_LOWLAT_MIN_VOL       500    // ...and mostly voluntary switches (per mille)
+
 /* ============================================================================
  * API FUNCTIONS
  * ============================================================================ */
@@ -125,8 +244,32 @@ void htas_set_scheduler(scheduler_type_t type);
 /* Get current scheduler type */
 scheduler_type_t htas_get_scheduler(void);
 
-/* System call: Set task profile hint */
+/* Printable scheduler name ("BASELINE", "HTAS", ...) */
+const char* htas_scheduler_name(scheduler_type_t type);
+
+/* One task's scheduler view (SYS_sched_get_stats) */
+typedef struct htas_task_stats {
+    uint32_t intent;                 // task_intent_t in effect
+    uint32_t preferred_numa_node;
+    cpumask_t affinity;
+    uint64_t runtime_us;             // On a CPU, user + system
+    uint64_t pcore_us;
+    uint64_t ecore_us;
+    uint64_t wait_us;                // Runnable but not picked
+    uint32_t voluntary_switches;     // Blocked or exited
+    uint32_t involuntary_switches;   // Preempted
+    uint64_t numa_penalties;
+} htas_task_stats_t;
+
+/* System calls for task hints. Each returns 0 or -1 (unknown pid, bad
+ * argument). A profile recomputes the affinity mask; an explicit mask is
+ * clipped to the online CPUs and lasts until the next profile. Tasks that
+ * never set a profile report PROFILE_DEFAULT and all online CPUs. */
 int sys_sched_set_profile(uint32_t pid, const task_profile_t* profile);
+int sys_sched_get_profile(uint32_t pid, task_profile_t* out);
+int sys_sched_set_affinity(uint32_t pid, cpumask_t mask);
+int sys_sched_get_affinity(uint32_t pid, cpumask_t* out);
+int sys_sched_get_stats(uint32_t pid, htas_task_stats_t* out);
 
 /* Scheduler tick integration helpers */
 struct process* htas_pick_next_process(struct process* current);
@@ -145,7 +288,7 @@ uint8_t htas_get_numa_node_for_address(void* addr);
 uint8_t htas_get_numa_node_for_cpu(uint8_t cpu_id);
 
 /* Calculate CPU affinity mask based on profile */
-uint32_t htas_calculate_affinity(const task_profile_t* profile);
+cpumask_t htas_calculate_affinity(const task_profile_t* profile);
 
 /* Check if process can run on CPU */
 bool htas_can_run_on_cpu(struct process* proc, uint8_t cpu_id);
@@ -156,10 +299,92 @@ struct process* htas_select_next(uint8_t cpu_id);
 /* Baseline round-robin selection */
 struct process* baseline_select_next(void);
 
+/* Intent used for policy decisions (PROFILE_DEFAULT when unhinted) */
+task_intent_t htas_task_intent(struct process* proc);
+
+/* Run queue membership, called by process.c when a task becomes
+ * runnable (READY/RUNNING) or stops being runnable. */
+void htas_enqueue_task(struct process* proc);
+void htas_dequeue_task(struct process* proc);
+
+/* FAIR class (htas_fair.c) */
+uint32_t htas_fair_weight(task_intent_t intent);
+void htas_fair_enqueue(struct process* proc);
+void htas_fair_dequeue(struct process* proc);
+void htas_fair_charge(struct process* proc, uint32_t delta_us);
+struct process* htas_fair_select_next(uint8_t cpu_id);
+
+/* Deadline class (htas_deadline.c). Runs ahead of every policy. */
+int  htas_dl_admit(struct process* proc, const task_profile_t* profile);
+void htas_dl_release(struct process* proc);
+void htas_dl_enqueue(struct process* proc);
+void htas_dl_dequeue(struct process* proc);
+void htas_dl_charge(struct process* proc, uint32_t delta_us);
+void htas_dl_replenish(void);
+struct process* htas_dl_select_next(uint8_t cpu_id);
+uint32_t htas_dl_total_util_permille(void);
+
+/* Scheduler clock in microseconds since boot */
+uint64_t htas_now_us(void);
+
+/* Length of one scheduler tick in microseconds (10000 before the PIT runs) */
+uint32_t htas_tick_us(void);
+
+/* Per-task scheduler state: reset on creation, released on exit */
+void htas_task_init(struct process* proc);
+void htas_task_exit(struct process* proc);
+
+/* Adaptive time slices for the HTAS policy (htas_slice.c). A controller
+ * retunes the slice of each intent from the wakeup latency and switch
+ * rate it measures; htas-slice reports both. */
+void htas_slice_init(void);
+void htas_slice_tick(void);
+void htas_slice_wakeup(struct process* proc);
+bool htas_slice_keep(struct process* current);
+void htas_slice_start(struct process* next);
+uint32_t htas_slice_ticks(task_intent_t intent);
+void htas_slice_set_enabled(bool enabled);
+void htas_slice_print(void);
+
+/* DYNAMIC class (htas_dynamic.c): infers an intent for unhinted tasks from
+ * CPU demand, burst length, voluntary switch ratio and I/O waits. */
+void htas_dyn_tick(struct process* current);
+void htas_dyn_switch(struct process* prev);
+void htas_dyn_memory_access(struct process* proc, uint8_t numa_node);
+uint8_t htas_dyn_numa_node(struct process* proc);
+struct process* htas_dyn_select_next(uint8_t cpu_id);
+
+/* CPU time accounting (htas_acct.c). Every switch, tick, syscall boundary
+ * and I/O wait closes the open interval and charges it to the right
+ * buckets, so per-task and per-intent times are exact to the TSC. */
+void htas_acct_tick(struct process* current);
+void htas_acct_switch(struct process* prev, struct process* next, uint8_t cpu_id);
+void htas_acct_syscall_enter(struct process* proc);
+void htas_acct_syscall_exit(struct process* proc);
+void htas_acct_io_begin(struct process* proc);
+void htas_acct_io_end(struct process* proc);
+void htas_acct_wakeup(struct process* proc);
+void htas_acct_exit(struct process* proc);
+void htas_acct_get(struct process* proc, struct proc_times* out);
+
+/* Idle residency measured by the idle governor: charges us at the entered
+ * state's draw, and the residency-weighted draw becomes the idle power of
+ * the simulator (defaults until anything was measured) */
+void htas_acct_idle(uint8_t cpu_id, uint32_t us, uint32_t power_per_ms);
+uint32_t htas_idle_power_per_ms(cpu_type_t type);
+
+/* Bracket a blocking wait (keyboard read, wait()) so it counts as I/O */
+void htas_io_wait_begin(struct process* proc);
+void htas_io_wait_end(struct process* proc);
+
 /* ============================================================================
  * STATISTICS & BENCHMARKING
  * ============================================================================ */
 
+/* Wakeup-to-run latency histogram: bucket 0 holds 0us, bucket b >= 1 holds
+ * [2^(b-1), 2^b) us, and the last bucket absorbs everything above. */
+#define LAT_HIST_BUCKETS 24
+
 typedef struct {
     uint64_t total_ticks;
     uint64_t context_switches;
@@ -171,16 +396,28 @@ typedef struct {
     struct {
         uint64_t runtime_us;
         uint64_t switches;
-        uint64_t avg_latency_us;  // For LOW_LATENCY tasks
-        uint64_t max_jitter_us;   // For LOW_LATENCY tasks
+        uint64_t avg_latency_us;  // Mean wakeup-to-run latency
+        uint64_t max_jitter_us;   // Worst wakeup-to-run latency
+        uint64_t latency_samples;
+        uint64_t latency_total_us;
+        uint32_t latency_hist[LAT_HIST_BUCKETS];
     } intent_stats[4];  // PERFORMANCE, EFFICIENCY, LOW_LATENCY, DEFAULT
     
     // Power simulation (arbitrary units)
     uint64_t total_power_consumption;
+
+    // Jain's index over weight-normalised task runtime (0-1000, simulator only)
+    uint32_t fairness_permille;
+
+    // Deadline-class jobs that completed, and how many finished late
+    uint64_t deadline_jobs;
+    uint64_t deadline_misses;
 } scheduler_stats_t;
 
 extern scheduler_stats_t g_baseline_stats;
 extern scheduler_stats_t g_htas_stats;
+extern scheduler_stats_t g_fair_stats;
+extern scheduler_stats_t g_dynamic_stats;
 
 /* Get current statistics */
 scheduler_stats_t* htas_get_stats(void);
@@ -188,6 +425,14 @@ scheduler_stats_t* htas_get_stats(void);
 /* Reset statistics */
 void htas_reset_stats(void);
 
+/* Add one wakeup-to-run latency sample for a task of the given intent */
+void htas_latency_record(scheduler_stats_t* stats, task_intent_t intent, uint32_t latency_us);
+
+/* Latency percentile (permille: 500 = p50) from the histogram. Returns the
+ * upper edge of the bucket holding it, capped at the observed maximum. */
+uint32_t htas_latency_percentile(const scheduler_stats_t* stats, task_intent_t intent,
+                                 uint32_t permille);
+
 /* Print statistics */
 void htas_print_stats(scheduler_stats_t* stats, const char* name);
 
@@ -195,6 +440,97 @@ void htas_print_stats(scheduler_stats_t* stats, const char* name);
 void htas_compare_stats(scheduler_stats_t* stats_a, const char* name_a,
                         scheduler_stats_t* stats_b, const char* name_b);
 
+/* ============================================================================
+ * WORKLOAD RECORD & REPLAY
+ * ============================================================================ */
+
+/* A recorded workload is scheduler independent: per task, when it arrived
+ * and then a list of phases, each "needs run_ms of CPU, then blocks for
+ * block_ms". Preemption is not recorded, so any policy can replay it.
+ *
+ * File format (little endian):
+ *   "HWL1" u16 ntasks u16 reserved u32 duration_ms
+ *   per task: u8 intent u8 numa u16 nphases u32 arrival_ms
+ *             then nphases x (u16 run_ms, u16 block_ms)
+ */
+#define WL_MAX_TASKS   16
+#define WL_MAX_PHASES  128
+
+typedef struct {
+    uint16_t run_ms;
+    uint16_t block_ms;               // 0 on the final phase of an exited task
+} wl_phase_t;
+
+typedef struct {
+    uint8_t intent;                  // Hint at record time (PROFILE_DEFAULT if none)
+    uint8_t numa;                    // NUMA node its memory lived on
+    uint16_t nphases;
+    uint32_t arrival_ms;             // Relative to the start of the recording
+    wl_phase_t phases[WL_MAX_PHASES];
+} wl_task_t;
+
+typedef struct {
+    uint16_t ntasks;
+    uint32_t duration_ms;
+    wl_task_t tasks[WL_MAX_TASKS];
+} wl_trace_t;
+
+void htas_wl_start(void);
+void htas_wl_stop(void);
+void htas_wl_print(void);
+int  htas_wl_save(const char* name);
+int  htas_wl_load(const char* name);
+const wl_trace_t* htas_wl_trace(void);
+
+/* Recorder hooks */
+void htas_wl_task_start(struct process* proc);
+void htas_wl_block_begin(struct process* proc);
+void htas_wl_block_end(struct process* proc);
+void htas_wl_task_exit(struct process* proc);
+
+/* Replay a workload through the simulator under BASELINE, HTAS and DYNAMIC */
+void htas_run_replay_benchmark(const wl_trace_t* trace);
+
+/* ============================================================================
+ * SIMULATOR CONFIGURATION
+ * ============================================================================ */
+
+#define SIM_MAX_TASKS  64
+#define SIM_MAX_CPUS   16
+#define SIM_MAX_NUMA   8
+
+/* One simulated scenario. The built-in 8-task mix is replicated up to
+ * task_count; CPUs [0, num_pcores) are P-cores and CPUs are split evenly
+ * across numa_nodes in order. */
+typedef struct {
+    uint32_t duration_ms;            // Simulated ticks (1 ms each)
+    int task_count;
+    int num_cpus;
+    int num_pcores;
+    int numa_nodes;
+    uint32_t effi_duty_cycle;        // EFFI tasks run 1 tick in every N
+    uint32_t aging_threshold;        // Ticks waiting before the aging boost
+    int aging_boost;
+    const wl_trace_t* replay;        // Replay this instead of the built-in mix
+} sim_config_t;
+
+/* Scratch state for one simulation run. Runs with separate contexts are
+ * independent, so they can go in parallel (see tools/htas_sim.c). */
+typedef struct sim_context sim_context_t;
+sim_context_t* htas_sim_context_alloc(void);
+
+/* Sweep task count, P/E ratio, NUMA nodes, duty cycle and aging threshold;
+ * one CSV row per grid point goes to serial. */
+void htas_run_sweep(uint32_t duration_ms);
+
+/* Sweep building blocks: grid points are numbered 0..htas_sweep_points()-1.
+ * htas_sweep_point() simulates every scheduler on one point, writes its CSV
+ * row (with newline) and returns the number of ticks simulated. */
+#define HTAS_SWEEP_ROW_MAX 512
+int htas_sweep_points(void);
+void htas_sweep_header(char* row);
+uint32_t htas_sweep_point(sim_context_t* ctx, int index, uint32_t duration_ms, char* row);
+
 /* ============================================================================
  * SHELL COMMAND WRAPPERS
  * ============================================================================ */
@@ -211,4 +547,7 @@ void htas_run_htas_benchmark(void);
 /* Print hardware topology */
 void htas_print_topology(void);
 
+/* Print per-process DYNAMIC inference state */
+void htas_print_inference(void);
+
 #endif /* _KERNEL_HTAS_H */
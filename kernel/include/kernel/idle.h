@@ -0,0 +1,68 @@
+#ifndef _KERNEL_IDLE_H
+#define _KERNEL_IDLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+struct registers;
+
+/* Idle governor.
+ *
+ * Every wait for an interrupt goes through idle_wait(): the governor
+ * predicts how long the CPU will stay idle (time to the next timer tick,
+ * corrected by the recent idle history) and enters the deepest state whose
+ * target residency fits the prediction and whose exit latency the waiting
+ * task tolerates. States, shallow to deep:
+ *
+ *   POLL  spin on the wakeup counter, then fall back to C1
+ *   C1    hlt
+ *   C1E+  mwait with the C-state hints CPUID leaf 5 reports
+ *
+ * The idle interval ends at the first interrupt (idle_irq_enter), so a
+ * task switch inside the wait does not inflate the residency. Measured
+ * residency feeds the HTAS power model (htas_acct_idle).
+ *
+ * When nothing is runnable process_schedule() switches to the idle task,
+ * a context outside the process table that loops in idle_wait().
+ */
+
+#define IDLE_MAX_STATES 6
+
+typedef enum {
+    IDLE_POLL,
+    IDLE_HLT,
+    IDLE_MWAIT,
+} idle_method_t;
+
+typedef struct {
+    const char* name;
+    idle_method_t method;
+    uint32_t hint;                   // mwait EAX
+    uint32_t exit_latency_us;
+    uint32_t target_residency_us;    // Break-even idle length
+    uint32_t power_per_ms;           // P-core draw, HTAS power units
+    bool enabled;
+
+    // Residency, updated as each idle interval closes
+    uint32_t usage;
+    uint32_t above;                  // Woke before the target residency
+    uint32_t below;                  // A deeper state would have fit
+    uint64_t residency_us;
+} idle_state_t;
+
+void idle_init(void);
+
+/* Wait for the next interrupt in the state the governor picks. Callable
+   with interrupts on or off; returns with them on. */
+void idle_wait(void);
+
+/* From irq_handler() before anything else: closes the idle interval */
+void idle_irq_enter(uint8_t irq);
+
+/* Initial frame of the idle task, 0 before idle_init() */
+struct registers* idle_task_frame(void);
+
+void idle_print(void);
+void idle_reset(void);
+
+#endif
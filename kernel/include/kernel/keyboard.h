@@ -21,6 +21,7 @@ enum {
 
 void keyboard_init(void);
 void keyboard_on_scancode(uint8_t sc);
+void keyboard_irq(void);   /* IRQ 1: queue the scancode, decode in a tasklet */
 int  kbd_getch(void);      /* returns -1 if none; ASCII or KEY_* above */
 
 #endif
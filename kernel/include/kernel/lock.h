@@ -0,0 +1,86 @@
+#ifndef _KERNEL_LOCK_H
+#define _KERNEL_LOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Kernel locks.
+ *
+ *   spinlock_t  ticket lock: FIFO, one cache line shared by all waiters
+ *   mcs_lock_t  MCS queue lock: FIFO, each waiter spins on its own node
+ *   mutex_t     sleeping lock for process context; never from an IRQ
+ *
+ * The _irqsave variants also disable interrupts and hand back the old
+ * EFLAGS for the matching _irqrestore; use them for anything an interrupt
+ * handler can take. With one CPU a spinner only gets the lock once the
+ * timer switches back to the holder, so hold spinlocks briefly.
+ *
+ * Every lock carries a lockstat_t, registered by its init call. While
+ * `lockstat on` is in effect, acquisitions, contended acquisitions and
+ * the wait in TSC cycles (total and worst) are counted per lock.
+ */
+
+typedef struct lockstat {
+    const char* name;
+    uint32_t acquired;
+    uint32_t contended;                 /* Had to wait */
+    uint64_t wait_total;                /* Cycles */
+    uint64_t wait_max;
+    struct lockstat* next;              /* Registry */
+} lockstat_t;
+
+typedef struct {
+    volatile uint16_t next;             /* Ticket handed to the next arrival */
+    volatile uint16_t owner;            /* Ticket now being served */
+    lockstat_t stat;
+} spinlock_t;
+
+typedef struct mcs_node {
+    struct mcs_node* volatile next;
+    volatile uint32_t locked;
+} mcs_node_t;
+
+typedef struct {
+    mcs_node_t* volatile tail;
+    lockstat_t stat;
+} mcs_lock_t;
+
+typedef struct {
+    spinlock_t guard;                   /* Protects the fields below */
+    int owner;                          /* pid, -1 when free */
+    uint32_t waiters;                   /* Bit per process slot */
+    lockstat_t stat;
+} mutex_t;
+
+extern volatile bool g_lockstat_enabled;
+
+/* name NULL: not listed by lockstat */
+void spin_lock_init(spinlock_t* lock, const char* name);
+void spin_lock(spinlock_t* lock);
+bool spin_trylock(spinlock_t* lock);
+void spin_unlock(spinlock_t* lock);
+uint32_t spin_lock_irqsave(spinlock_t* lock);
+void spin_unlock_irqrestore(spinlock_t* lock, uint32_t flags);
+
+/* The caller provides the queue node, normally on its stack, and passes
+   the same node to unlock */
+void mcs_lock_init(mcs_lock_t* lock, const char* name);
+void mcs_lock(mcs_lock_t* lock, mcs_node_t* node);
+void mcs_unlock(mcs_lock_t* lock, mcs_node_t* node);
+uint32_t mcs_lock_irqsave(mcs_lock_t* lock, mcs_node_t* node);
+void mcs_unlock_irqrestore(mcs_lock_t* lock, mcs_node_t* node, uint32_t flags);
+
+void mutex_init(mutex_t* m, const char* name);
+void mutex_lock(mutex_t* m);
+bool mutex_trylock(mutex_t* m);
+void mutex_unlock(mutex_t* m);
+
+uint32_t irq_save(void);
+void irq_restore(uint32_t flags);
+
+/* Shell: lockstat [on|off|reset] */
+void lockstat_set(bool enabled);
+void lockstat_reset(void);
+void lockstat_print(void);
+
+#endif
@@ -3,11 +3,13 @@
 
 #include <stdint.h>
 #include <kernel/idt.h>  /* for struct registers */
-
-/* Forward declaration for HTAS */
-typedef struct htas_task_info htas_task_info_t;
+#include <kernel/htas.h> /* for htas_task_info_t, htas_entity_t */
+#include <kernel/rcu.h>
+#include <stdbool.h>
 
 #define MAX_PROCESSES 32
+#define KERNEL_PID    0   /* The boot context (kernel shell), a kthread */
+#define KSTACK_SIZE   (8*1024)  /* Per-process kernel stack */
 
 typedef enum {
     PROC_UNUSED = 0,
@@ -17,28 +19,51 @@ typedef enum {
     PROC_ZOMBIE
 } proc_state_t;
 
-/* Saved user context for a process */
-typedef struct {
-    uint32_t eax, ebx, ecx, edx;
-    uint32_t esi, edi, ebp, esp;
-    uint32_t eip;
-    uint32_t eflags;
-    uint32_t cs, ds, ss, es, fs, gs;
-} proc_context_t;
+/* Every schedulable entity is a process_t with its own kernel stack.
+   Kernel threads run only in ring 0 on it; user processes run in ring 3
+   and enter the kernel on it (TSS esp0 follows the running process).
+   A task that is not running is just its saved interrupt frame on that
+   stack, so a switch is a stack pointer swap. */
+typedef enum {
+    PROC_KIND_USER = 0,
+    PROC_KIND_KTHREAD,
+} proc_kind_t;
+
+/* CPU time totals for one process (SYS_proc_times, ps), in microseconds */
+typedef struct proc_times {
+    uint64_t user_us;       // Running in user mode
+    uint64_t sys_us;        // Running inside system calls
+    uint64_t pcore_us;      // On-CPU time spent on P-cores
+    uint64_t ecore_us;      // On-CPU time spent on E-cores
+    uint64_t wait_us;       // Runnable, waiting for a CPU
+    uint64_t iowait_us;     // Blocked in read/wait
+} proc_times_t;
 
 /* Process Control Block */
 typedef struct process {
     int pid;
     int ppid;               // Parent process ID
     proc_state_t state;
+    proc_kind_t kind;
+    char name[16];
     uint32_t page_dir;      // Physical address of page directory
-    proc_context_t context; // Saved user registers
+    struct registers* kframe; // Frame to resume from, on kstack (NULL: never ran)
+    void* kstack;           // KSTACK_SIZE bytes (NULL: kthread 0, the boot stack)
     int exit_code;          // Exit code when zombie
     uint32_t brk;           // Current program break for sbrk/brk
+    int tgid;               // Thread group: pid of the leader whose memory it shares
+    uint32_t tls_base;      // Base of the USER_TLS segment (gs) while it runs
+    struct wait_queue* wait_q; // Queue it sleeps on (wait.h), unlinked on destroy
     
     /* HTAS scheduler extensions */
     htas_task_info_t* htas_info;  // Task profile and statistics
+    htas_entity_t se;              // Run queue state for every process
     void* user_data;               // For benchmark identification
+
+    /* The scheduler reads the table without locks; a destroyed slot is
+       reused only after an RCU grace period */
+    struct rcu_head rcu;
+    bool reclaim_pending;
 } process_t;
 
 /* Initialize process management */
@@ -47,7 +72,15 @@ void process_init(void);
 /* Create a new process (allocates PID and PCB) */
 int process_create(int ppid);
 
-/* Find process by PID */
+/* Allocate a PID and PCB without making it runnable; the caller sets it
+   up and then moves it to PROC_READY with process_set_state() */
+process_t* process_alloc(int ppid);
+
+/* Top of a process's kernel stack (TSS esp0 while it runs) */
+uint32_t process_kstack_top(process_t* proc);
+
+/* Find process by PID. The pointer stays valid (if possibly dead) for
+   the caller's RCU read section or interrupts-off region. */
 process_t* process_find(int pid);
 
 /* Get current running process */
@@ -68,22 +101,37 @@ void process_yield(void);
 /* Set current running process */
 void process_set_current(int pid);
 
+/* Change a process state, keeping the scheduler run queues in sync */
+void process_set_state(process_t* proc, proc_state_t state);
+
 /* Destroy a process and free its resources */
 void process_destroy(int pid);
 
-/* Fork current process - returns child PID to parent, 0 to child */
-int process_fork(void);
+/* Fork current process - returns child PID to parent, 0 to child.
+   regs is the parent's system call frame. */
+int process_fork(struct registers* regs);
+
+/* Start a thread of the current process at entry with the given user
+   stack and TLS base. It shares the page directory, program break and
+   file table, is a child of the caller (reaped by wait) and starts with
+   the caller's HTAS profile. Returns its pid (thread id) or -1. */
+int process_clone(struct registers* regs, uint32_t entry, uint32_t stack, uint32_t tls);
+
+/* Destroy every other thread of a group leader (its memory goes with it) */
+void process_kill_threads(process_t* leader);
 
 /* Exit current process with exit code */
 void process_exit(int code);
 
-/* Wait for child process to exit */
-int process_wait(int* status);
+/* Wait for a child (pid, or any when pid <= 0) to exit */
+int process_wait(int pid, int* status);
 
-/* Switch to a different process */
-void process_switch(int new_pid);
+/* Pick the next kthread or process to run (called from the timer
+   interrupt). Returns the frame to resume: regs, or the saved frame of
+   the task switched to. */
+struct registers* process_schedule(struct registers* regs);
 
-/* Schedule next ready process (called from timer interrupt) */
-void process_schedule(struct registers* regs);
+/* Print the process table with CPU times (shell 'ps') */
+void process_ps(void);
 
 #endif
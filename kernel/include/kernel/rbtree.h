@@ -0,0 +1,50 @@
+#ifndef _KERNEL_RBTREE_H
+#define _KERNEL_RBTREE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Intrusive red-black tree. Embed a struct rb_node in the object and use
+   rb_entry() to get back to it. Callers do the key comparison themselves
+   (walk rb_link down from the root, then rb_link_node + rb_insert_color). */
+
+#define RB_RED   0
+#define RB_BLACK 1
+
+struct rb_node {
+    struct rb_node* parent;
+    struct rb_node* left;
+    struct rb_node* right;
+    int color;
+};
+
+struct rb_root {
+    struct rb_node* node;
+};
+
+#define RB_ROOT_INIT { NULL }
+
+#define rb_entry(ptr, type, member) \
+    ((type*)((char*)(ptr) - offsetof(type, member)))
+
+/* Attach 'node' as a child of 'parent' at '*link' (not yet balanced). */
+static inline void rb_link_node(struct rb_node* node, struct rb_node* parent,
+                                struct rb_node** link) {
+    node->parent = parent;
+    node->left = NULL;
+    node->right = NULL;
+    node->color = RB_RED;
+    *link = node;
+}
+
+/* Rebalance after rb_link_node(). */
+void rb_insert_color(struct rb_node* node, struct rb_root* root);
+
+/* Remove a node that is currently linked into 'root'. */
+void rb_erase(struct rb_node* node, struct rb_root* root);
+
+/* In-order traversal helpers. */
+struct rb_node* rb_first(const struct rb_root* root);
+struct rb_node* rb_next(const struct rb_node* node);
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef _KERNEL_RCU_H
+#define _KERNEL_RCU_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Read-copy-update, quiescent-state based.
+ *
+ * Readers run between rcu_read_lock() and rcu_read_unlock() and take no
+ * lock: the pair only bumps this CPU's nesting count, and the scheduler
+ * does not switch away from a task inside a read section. Code running
+ * with interrupts off (IRQ handlers, syscalls) is a read section already.
+ *
+ * A CPU passes through a quiescent state when a timer tick finds it
+ * outside any read section, or when it switches tasks. A grace period
+ * ends once every online CPU has done so after it began; by then no
+ * reader can still hold a pointer it loaded before the grace period.
+ *
+ * Writers publish with rcu_assign_pointer() and then either block in
+ * synchronize_rcu() or queue call_rcu(). Callbacks run from SOFTIRQ_RCU
+ * with interrupts on; they must not sleep (typically a kfree).
+ */
+
+#define RCU_MAX_CPUS 64
+
+struct rcu_head {
+    struct rcu_head* next;
+    void (*func)(struct rcu_head* head);
+    uint32_t gp;                        /* Grace period it waits for */
+};
+
+#define rcu_dereference(p)        __atomic_load_n(&(p), __ATOMIC_CONSUME)
+#define rcu_assign_pointer(p, v)  __atomic_store_n(&(p), (v), __ATOMIC_RELEASE)
+
+/* Registers the callback softirq */
+void rcu_init(void);
+
+void rcu_read_lock(void);
+void rcu_read_unlock(void);
+bool rcu_read_lock_held(void);
+
+void synchronize_rcu(void);
+void call_rcu(struct rcu_head* head, void (*func)(struct rcu_head* head));
+
+/* Quiescent-state reports: timer tick (from the interrupted context's
+   point of view) and context switch */
+void rcu_tick(void);
+void rcu_note_context_switch(void);
+
+#endif
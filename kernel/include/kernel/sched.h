@@ -3,19 +3,26 @@
 
 #include <stdint.h>
 
+/* Kernel threads are process_t entries of kind PROC_KIND_KTHREAD and are
+   picked by the same HTAS/baseline policy as user processes
+   (process_schedule, once per timer tick). */
+
 typedef void (*kthread_fn)(void*);
 
-#define SCHED_PRIORITY_REALTIME   0
-#define SCHED_PRIORITY_INTERACTIVE 1
-#define SCHED_PRIORITY_BACKGROUND  2
-#define SCHED_PRIORITY_BATCH       3
+struct registers;
+
+/* Priority classes, mapped onto HTAS intents */
+#define SCHED_PRIORITY_REALTIME   0   /* LOW_LATENCY */
+#define SCHED_PRIORITY_INTERACTIVE 1  /* DEFAULT */
+#define SCHED_PRIORITY_BACKGROUND  2  /* EFFICIENCY */
+#define SCHED_PRIORITY_BATCH       3  /* EFFICIENCY */
 #define SCHED_PRIORITY_LEVELS      4
 
-void sched_init(void);
+/* Returns the new thread's pid, or -1 */
 int  kthread_create(kthread_fn fn, void* arg, const char* name);
+/* Initial frame on a KSTACK_SIZE stack that starts fn(arg) when resumed */
+struct registers* kthread_frame(void* stack, kthread_fn fn, void* arg);
 int  sched_set_priority(int pid, int priority);
 void sched_yield(void);
-void sched_tick(void); /* call from timer IRQ */
-void sched_ps(void);
 
 #endif
@@ -7,6 +7,7 @@
 
 void serial_init(void);
 void serial_putchar(char c);
+void serial_putbyte(uint8_t b);   /* raw, no LF -> CRLF translation */
 void serial_writestring(const char* s);
 int  serial_available(void);
 int  serial_getchar(void); /* returns -1 if no data */
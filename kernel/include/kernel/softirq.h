@@ -0,0 +1,86 @@
+#ifndef _KERNEL_SOFTIRQ_H
+#define _KERNEL_SOFTIRQ_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <kernel/wait.h>
+
+struct registers;
+
+/* Interrupt bottom halves.
+ *
+ * A hard interrupt handler only acknowledges the device and records what
+ * happened; the rest is deferred to one of two places:
+ *
+ *   softirqs   a fixed set of vectors run at interrupt exit, after the
+ *              EOI, with interrupts on. Tasklets (one-shot functions
+ *              queued from a handler) run from SOFTIRQ_TASKLET.
+ *   IRQ threads  kthreads with a scheduler priority that sleep until a
+ *              handler wakes them, for work that may take a while.
+ *
+ * Softirqs do not nest: an interrupt taken while they run only raises
+ * more. The timer's reschedule is held back until they finish, so the
+ * task switch happens with the interrupted context's stack unwound.
+ */
+
+enum {
+    SOFTIRQ_HI,            /* Tasklets that must run first */
+    SOFTIRQ_RCU,           /* Callbacks whose grace period ended */
+    SOFTIRQ_TASKLET,
+    NR_SOFTIRQS,
+};
+
+typedef void (*softirq_fn)(void);
+
+void softirq_init(void);
+void open_softirq(int nr, softirq_fn fn);
+
+/* Any context; the vector runs at the next interrupt exit */
+void raise_softirq(int nr);
+
+/* True while softirqs run (the interrupted code is below us) */
+bool in_softirq(void);
+
+typedef struct tasklet {
+    struct tasklet* next;
+    void (*fn)(uintptr_t data);
+    uintptr_t data;
+    volatile bool scheduled;           /* Queued and not yet run */
+} tasklet_t;
+
+#define TASKLET_INIT(f, d) { .next = 0, .fn = (f), .data = (d), .scheduled = false }
+
+/* Queue t once; scheduling it again before it runs is a no-op */
+void tasklet_schedule(tasklet_t* t);
+void tasklet_hi_schedule(tasklet_t* t);
+
+#define IRQ_THREADS_MAX 4
+
+typedef struct irq_thread {
+    const char* name;
+    void (*fn)(void);
+    int pid;
+    volatile bool pending;
+    wait_queue_t wq;
+    uint32_t wakeups;
+    uint32_t runs;
+} irq_thread_t;
+
+/* Start a kthread at a SCHED_PRIORITY_* class that calls fn once per
+   batch of wakeups; NULL when no slot or process is free */
+irq_thread_t* irq_thread_create(const char* name, void (*fn)(void), int priority);
+
+/* From a hard handler; a thread already pending is not woken twice */
+void irq_thread_wake(irq_thread_t* t);
+
+/* irq_handler() brackets each interrupt with these. irq_exit() runs the
+   pending softirqs and, if a timer tick came in, the scheduler; it
+   returns the frame to resume. */
+void irq_enter(uint8_t irq);
+struct registers* irq_exit(struct registers* regs, bool tick);
+
+/* irqstat: worst-case interrupts-off time per IRQ and softirq time */
+void irq_stat_print(void);
+void irq_stat_reset(void);
+
+#endif
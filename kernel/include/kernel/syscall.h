@@ -15,5 +15,29 @@
 #define SYS_wait   11
 #define SYS_getpid 12
 #define SYS_getppid 13
+/* CPU time totals: (pid or 0 for self, struct proc_times*) */
+#define SYS_proc_times 14
+/* Shared I/O rings: (uring_t*, entries, flags) -> id; (id, to_submit) */
+#define SYS_uring_setup 15
+#define SYS_uring_enter 16
+/* Threads: (entry, stack top, TLS base) -> thread id; TLS base of the
+   calling thread; own thread id (getpid returns the group's) */
+#define SYS_clone   17
+#define SYS_set_tls 18
+#define SYS_gettid  19
+/* Futexes: (uaddr, expected value) sleeps while *uaddr == value;
+   (uaddr, n) wakes up to n sleepers */
+#define SYS_futex_wait 20
+#define SYS_futex_wake 21
+/* HTAS hints, pid 0 = the calling thread: (pid, task_profile_t*),
+   (pid, cpumask_t*), (pid, htas_task_stats_t*) */
+#define SYS_sched_set_profile  22
+#define SYS_sched_get_profile  23
+#define SYS_sched_set_affinity 24
+#define SYS_sched_get_affinity 25
+#define SYS_sched_get_stats    26
+
+/* Console output shared by SYS_write and the rings */
+int syscall_console_write(const char* buf, unsigned len);
 
 #endif
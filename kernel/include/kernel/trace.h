@@ -0,0 +1,57 @@
+#ifndef _KERNEL_TRACE_H
+#define _KERNEL_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Binary scheduler trace. A fixed set of rings of fixed-size events; CPU n
+   writes ring n % TRACE_RINGS, so machines with more CPUs share rings and
+   the event's cpu field says which CPU it came from. Writers reserve a slot
+   with an atomic increment, so interrupt and syscall context can both emit
+   without locks. When a ring wraps the oldest events are overwritten. Stop
+   tracing before dumping. */
+
+#define TRACE_RING_EVENTS 1024          /* per ring, power of two */
+#define TRACE_RINGS       8             /* power of two */
+
+typedef enum {
+    TRACE_SWITCH  = 1,   /* pid = prev, arg0 = next pid, arg1 = prev state */
+    TRACE_WAKEUP  = 2,   /* pid, arg0 = intent */
+    TRACE_MIGRATE = 3,   /* pid, arg0 = from cpu, arg1 = to cpu */
+    TRACE_TICK    = 4,   /* pid = current, arg0 = low 16 bits of PIT ticks */
+    TRACE_PROFILE = 5,   /* pid, arg0 = intent, arg1 = affinity mask, CPUs 0-15 */
+} trace_type_t;
+
+typedef struct trace_event {
+    uint64_t tsc;
+    uint8_t  type;
+    uint8_t  cpu;
+    uint16_t pid;
+    uint16_t arg0;
+    uint16_t arg1;
+} trace_event_t;                        /* 16 bytes, little endian on the wire */
+
+/* Serial dump layout (all little endian):
+     "HTRC" u16 version u16 nrings u32 tsc_khz
+     per ring: u16 ring u16 reserved u32 count, then count trace_event_t
+     "CRTH" */
+#define TRACE_DUMP_VERSION 1
+
+extern volatile bool g_trace_enabled;
+
+void trace_emit(uint8_t cpu, trace_type_t type, uint16_t pid, uint16_t arg0, uint16_t arg1);
+
+/* Fast path: a single load when tracing is off */
+static inline void trace_event(uint8_t cpu, trace_type_t type, uint16_t pid,
+                               uint16_t arg0, uint16_t arg1) {
+    if (g_trace_enabled) {
+        trace_emit(cpu, type, pid, arg0, arg1);
+    }
+}
+
+void trace_start(void);     /* Clears the rings and enables tracing */
+void trace_stop(void);
+void trace_dump_serial(void);
+void trace_status(void);
+
+#endif
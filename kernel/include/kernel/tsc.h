@@ -0,0 +1,24 @@
+#ifndef _KERNEL_TSC_H
+#define _KERNEL_TSC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Time stamp counter clock. tsc_calibrate() measures the TSC rate against
+   PIT channel 2 once at boot; without a usable TSC the clock falls back to
+   PIT ticks and tsc_read() returns microseconds. */
+
+void tsc_calibrate(void);
+
+/* True once calibration found a working TSC */
+bool tsc_available(void);
+
+/* Raw counter (cycles) */
+uint64_t tsc_read(void);
+
+/* Counter rate in kHz (cycles per millisecond) */
+uint32_t tsc_khz(void);
+
+uint64_t tsc_cycles_to_us(uint64_t cycles);
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef _KERNEL_URING_H
+#define _KERNEL_URING_H
+
+#include <stdint.h>
+
+/* Submission/completion rings shared with a process (io_uring-style).
+   The process allocates URING_SIZE(entries) bytes of its own memory and
+   registers it with SYS_uring_setup; the kernel fills in the header.
+
+     sq: user writes sqes[sq_tail & mask] and then bumps sq_tail;
+         the kernel consumes from sq_head
+     cq: the kernel writes cqes[cq_tail & mask] and then bumps cq_tail;
+         the user reaps from cq_head
+
+   Without URING_SETUP_SQPOLL, SYS_uring_enter consumes up to to_submit
+   entries in one trap. With it, a kernel thread polls the ring every
+   tick and no syscall is needed at all. Operations complete in order.
+   The kernel stops consuming while the CQ is full, so a completion is
+   never dropped. Console input (read on fd 0) blocks, so it stays on the
+   plain read syscall. */
+
+#define URING_MAX_ENTRIES 256           /* power of two */
+#define URING_MAX_RINGS   4
+
+#define URING_SETUP_SQPOLL 0x1
+
+enum {
+    URING_OP_NOP   = 0,
+    URING_OP_READ  = 1,                 /* fd, addr = buffer, len */
+    URING_OP_WRITE = 2,                 /* fd 1/2: console, else file */
+    URING_OP_OPEN  = 3,                 /* addr = NUL-terminated name */
+    URING_OP_CLOSE = 4,                 /* fd */
+};
+
+typedef struct uring_sqe {
+    uint8_t  opcode;
+    uint8_t  flags;                     /* None defined yet, must be 0 */
+    uint16_t reserved;
+    int32_t  fd;
+    uint32_t addr;
+    uint32_t len;
+    uint32_t user_data;                 /* Copied to the completion */
+} uring_sqe_t;
+
+typedef struct uring_cqe {
+    uint32_t user_data;
+    int32_t  res;                       /* As the matching syscall, -1 on error */
+} uring_cqe_t;
+
+typedef struct uring {
+    volatile uint32_t sq_head;
+    volatile uint32_t sq_tail;
+    volatile uint32_t cq_head;
+    volatile uint32_t cq_tail;
+    uint32_t entries;                   /* Both rings */
+    uint32_t flags;                     /* URING_SETUP_* */
+    /* uring_sqe_t sqes[entries]; uring_cqe_t cqes[entries]; */
+} uring_t;
+
+#define URING_SIZE(entries) \
+    (sizeof(uring_t) + (entries) * (sizeof(uring_sqe_t) + sizeof(uring_cqe_t)))
+
+/* SYS_uring_setup: returns a ring id or -1 */
+int uring_setup(uring_t* ring, uint32_t entries, uint32_t flags);
+
+/* SYS_uring_enter: entries consumed, or -1 */
+int uring_enter(int id, uint32_t to_submit);
+
+/* Drop every ring the process owns (and its poller); on process teardown */
+void uring_release(int pid);
+
+#endif
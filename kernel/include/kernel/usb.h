@@ -94,5 +94,9 @@ typedef struct {
 /* USB API */
 int usb_init(void);
 void usb_poll(void);
+/* Timer tick: wake the poll thread when the controller flags a transfer */
+void usb_tick(void);
+/* Move polling into an IRQ thread (needs the process table) */
+void usb_start_thread(void);
 
 #endif
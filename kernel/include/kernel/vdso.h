@@ -0,0 +1,39 @@
+#ifndef _KERNEL_VDSO_H
+#define _KERNEL_VDSO_H
+
+#include <stdint.h>
+
+/* Kernel-maintained data page, mapped read-only for ring 3 at VDSO_ADDR
+   in the kernel half (its page table holds nothing else user-visible).
+   User code reads the time and its own identity from it without a trap;
+   see user/vdso.c. The kernel bumps seq to odd before writing and back to
+   even after, so a reader retries when seq was odd or changed under it. */
+
+#define VDSO_ADDR    0xFFFFE000u
+#define VDSO_VERSION 1
+#define VDSO_SHIFT   20
+
+typedef struct vdso_data {
+    volatile uint32_t seq;
+    uint32_t version;
+    /* ns = ns_base + ((tsc - tsc_base) * tsc_mult >> VDSO_SHIFT);
+       tsc_mult 0: no TSC, ns_base alone (tick resolution) */
+    uint32_t tsc_mult;
+    uint32_t tick_hz;
+    uint64_t tsc_base;
+    uint64_t ns_base;
+    uint64_t ticks;                     /* PIT ticks since boot */
+    int32_t  pid;                       /* Task now running */
+    int32_t  ppid;
+} vdso_data_t;
+
+/* Map the page; needs the TSC calibrated and paging up */
+int vdso_init(void);
+
+/* Timer tick: advance the clock and tick count */
+void vdso_tick(void);
+
+/* Context switch: identity of the task about to run */
+void vdso_set_task(int pid, int ppid);
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef _KERNEL_WAIT_H
+#define _KERNEL_WAIT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <kernel/lock.h>
+
+/* Wait queues for process context.
+ *
+ * A sleeper links an entry (on its own kernel stack) into the queue under
+ * a key and blocks; wait_queue_wake() makes the oldest matching sleepers
+ * READY. The caller locks the queue first so it can check its condition
+ * and go to sleep without a wakeup slipping in between:
+ *
+ *   uint32_t flags = wait_queue_lock(wq);
+ *   if (!condition) wait_queue_sleep_locked(wq, key, flags);
+ *   else wait_queue_unlock(wq, flags);
+ *
+ * A process destroyed while asleep is unlinked by wait_queue_cancel().
+ */
+
+struct process;
+
+typedef struct wait_entry {
+    struct process* proc;
+    uint32_t key;
+    volatile bool woken;
+    struct wait_entry* next;
+} wait_entry_t;
+
+typedef struct wait_queue {
+    spinlock_t lock;
+    wait_entry_t* head;                 /* FIFO */
+} wait_queue_t;
+
+/* name registers the queue lock with lockstat; NULL leaves it out */
+void wait_queue_init(wait_queue_t* wq, const char* name);
+
+uint32_t wait_queue_lock(wait_queue_t* wq);
+void wait_queue_unlock(wait_queue_t* wq, uint32_t flags);
+
+/* Called with the queue locked; returns unlocked once woken */
+void wait_queue_sleep_locked(wait_queue_t* wq, uint32_t key, uint32_t flags);
+
+/* Wake up to n sleepers queued under key; returns how many */
+int wait_queue_wake(wait_queue_t* wq, uint32_t key, int n);
+
+/* Unlink a process that will never run again */
+void wait_queue_cancel(struct process* proc);
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef _KERNEL_WORKQUEUE_H
+#define _KERNEL_WORKQUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Kernel worker pool.
+ *
+ * One worker kthread per online CPU (up to WQ_MAX_WORKERS), each pinned
+ * to its CPU and owning a deque of work items. A worker takes the newest
+ * item from its own deque, then the oldest from the others (stealing),
+ * and sleeps when every deque is empty.
+ *
+ * queue_work() runs an item asynchronously, so the caller can block on
+ * I/O meanwhile. kparallel_for() splits a range into chunks spread over
+ * the deques and has the caller run chunks too until the range is done;
+ * with interrupts off, or before the pool starts, the caller ends up
+ * running all of it inline.
+ *
+ * Only the API is in place: no subsystem queues work yet, and "wq bench"
+ * is the one user of kparallel_for().
+ */
+
+#define WQ_MAX_WORKERS  4
+#define WQ_DEQUE_SIZE   64
+#define KPAR_MAX_CHUNKS 32
+
+struct work;
+typedef void (*work_fn)(struct work* work);
+
+typedef struct work {
+    work_fn fn;
+    volatile bool pending;              /* Queued or running */
+} work_t;
+
+#define WORK_INIT(f) { .fn = (f), .pending = false }
+
+/* Needs HTAS for the CPU count and placement */
+void workqueue_init(void);
+
+/* Run work->fn(work) on a worker; false when it is still pending.
+   A full pool runs it inline. */
+bool queue_work(work_t* work);
+
+/* Sleep until work has run */
+void flush_work(work_t* work);
+
+/* fn(begin, end, arg) on sub-ranges of [begin, end) no shorter than
+   grain (except the last). Returns once every sub-range has run. */
+typedef void (*kpar_fn)(uint32_t begin, uint32_t end, void* arg);
+void kparallel_for(uint32_t begin, uint32_t end, uint32_t grain, kpar_fn fn, void* arg);
+
+int workqueue_workers(void);
+
+/* Shell: wq [bench [KB]] */
+void workqueue_print(void);
+void workqueue_bench(uint32_t kb);
+
+#endif
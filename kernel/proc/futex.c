@@ -0,0 +1,45 @@
+#include <kernel/futex.h>
+#include <kernel/wait.h>
+#include <kernel/vmm.h>
+
+#define FUTEX_BUCKETS  64               /* Power of two */
+#define USER_LIMIT     0xC0000000u
+
+static wait_queue_t s_buckets[FUTEX_BUCKETS];
+
+void futex_init(void) {
+    for (int i = 0; i < FUTEX_BUCKETS; i++) {
+        wait_queue_init(&s_buckets[i], 0);
+    }
+}
+
+/* Physical address of the word, 0 when it cannot be a futex */
+static uint32_t futex_key(uint32_t uaddr) {
+    if ((uaddr & 3) || uaddr == 0 || uaddr >= USER_LIMIT) return 0;
+    return vmm_resolve(uaddr);
+}
+
+static wait_queue_t* futex_bucket(uint32_t key) {
+    return &s_buckets[((key >> 2) * 2654435761u) >> 26];
+}
+
+int futex_wait(uint32_t uaddr, uint32_t val) {
+    uint32_t key = futex_key(uaddr);
+    if (!key) return -1;
+
+    wait_queue_t* wq = futex_bucket(key);
+    uint32_t flags = wait_queue_lock(wq);
+    if (*(volatile uint32_t*)uaddr != val) {
+        wait_queue_unlock(wq, flags);
+        return -1;
+    }
+    wait_queue_sleep_locked(wq, key, flags);
+    return 0;
+}
+
+int futex_wake(uint32_t uaddr, int n) {
+    uint32_t key = futex_key(uaddr);
+    if (!key) return -1;
+    if (n <= 0) return 0;
+    return wait_queue_wake(futex_bucket(key), key, n);
+}
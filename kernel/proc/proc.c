@@ -63,13 +63,17 @@ int run_user_and_wait(void* entry, uint32_t user_stack_top) {
     
     proc->page_dir = read_cr3();
     
-    proc->context.eip = (uint32_t)entry;
-    proc->context.esp = user_stack_top;
-    proc->context.ebp = 0;
-    proc->context.eflags = 0x202;
-    proc->context.cs = 0x1B;
-    proc->context.ss = 0x23;
-    proc->context.ds = 0x23;
+    // Traps from ring 3 land on the process's own kernel stack
+    tss_set_kernel_stack(process_kstack_top(proc));
+    gdt_set_tls(proc->tls_base);
+
+    // The calling kthread sleeps until the process exits; iret re-enables
+    // interrupts once the hand-over is complete
+    process_t* caller = process_current();
+    __asm__ volatile("cli");
+    if (caller) {
+        process_set_state(caller, PROC_BLOCKED);
+    }
     proc->state = PROC_RUNNING;
     
     process_set_current(pid);
@@ -82,6 +86,10 @@ int run_user_and_wait(void* entry, uint32_t user_stack_top) {
     __asm__ volatile("": : : "memory");
     
 after_user:
+    if (caller) {
+        process_set_state(caller, PROC_RUNNING);
+        process_set_current(caller->pid);
+    }
     printf("[proc] after_user: resumed in kernel, exit_code=%d\n", proc_last_exit_code());
     
     // Clean up the process
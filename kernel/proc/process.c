@@ -4,13 +4,29 @@
 #include <kernel/vmm.h>
 #include <kernel/stdio.h>
 #include <kernel/htas.h>
+#include <kernel/gdt.h>
+#include <kernel/vdso.h>
+#include <kernel/uring.h>
+#include <kernel/kmalloc.h>
+#include <kernel/idle.h>
+#include <kernel/wait.h>
 #include <string.h>
+#include <stddef.h>
 #include <stdbool.h>
 
 static process_t process_table[MAX_PROCESSES];
 static int current_pid = -1;
 static int next_pid = 1;
 
+// The idle task runs when nothing else can; it has no slot, so current_pid
+// is -1 meanwhile and its frame is kept here
+static bool idle_running = false;
+static struct registers* idle_frame = 0;
+
+/* One kernel stack per process slot; slot 0's goes unused (kthread 0
+   keeps the boot stack) */
+static uint8_t kstacks[MAX_PROCESSES][KSTACK_SIZE] __attribute__((aligned(16)));
+
 /* Helper: get kernel page directory (CR3) */
 static inline uint32_t read_cr3(void) {
     uint32_t cr3;
@@ -90,30 +106,74 @@ static void free_user_address_space(uint32_t pd_phys) {
     }
 }
 
+static inline bool state_is_runnable(proc_state_t state) {
+    return state == PROC_READY || state == PROC_RUNNING;
+}
+
+void process_set_state(process_t* proc, proc_state_t state) {
+    bool was_runnable = state_is_runnable(proc->state);
+    bool runnable = state_is_runnable(state);
+
+    proc->state = state;
+
+    if (runnable && !was_runnable) {
+        htas_enqueue_task(proc);
+    } else if (!runnable && was_runnable) {
+        htas_dequeue_task(proc);
+    }
+}
+
 void process_init(void) {
     memset(process_table, 0, sizeof(process_table));
     current_pid = -1;
-    next_pid = 1;
+    next_pid = KERNEL_PID;
+
+    // The boot context (this stack, running the shell) is kthread 0
+    process_t* kernel = process_alloc(0);
+    kernel->kind = PROC_KIND_KTHREAD;
+    kernel->kstack = 0;
+    memcpy(kernel->name, "kernel", 7);
+    kernel->se.acct_in_kernel = true;
+    process_set_state(kernel, PROC_RUNNING);
+    current_pid = kernel->pid;
+
     printf("process: initialized (max=%d)\n", MAX_PROCESSES);
 }
 
-int process_create(int ppid) {
+process_t* process_alloc(int ppid) {
     // Find free slot
     for (int i = 0; i < MAX_PROCESSES; i++) {
-        if (process_table[i].state == PROC_UNUSED) {
+        if (process_table[i].state == PROC_UNUSED && !process_table[i].reclaim_pending) {
             process_table[i].pid = next_pid++;
             process_table[i].ppid = ppid;
-            process_table[i].state = PROC_READY;
+            process_table[i].kind = PROC_KIND_USER;
+            process_table[i].name[0] = '\0';
             process_table[i].page_dir = 0;
             process_table[i].exit_code = 0;
             process_table[i].brk = 0;
-            process_table[i].htas_info = 0;  // Initialize HTAS info
+            process_table[i].tgid = process_table[i].pid;
+            process_table[i].tls_base = 0;
+            process_table[i].wait_q = 0;
+            process_table[i].kframe = 0;
+            process_table[i].kstack = kstacks[i];
+            process_table[i].htas_info = 0;  // Freed by process_reclaim()
             process_table[i].user_data = 0;  // Initialize user data
-            memset(&process_table[i].context, 0, sizeof(proc_context_t));
-            return process_table[i].pid;
+            htas_task_init(&process_table[i]);
+            return &process_table[i];
         }
     }
-    return -1; // No free slots
+    return 0; // No free slots
+}
+
+int process_create(int ppid) {
+    process_t* proc = process_alloc(ppid);
+    if (!proc) return -1;
+    process_set_state(proc, PROC_READY);
+    return proc->pid;
+}
+
+uint32_t process_kstack_top(process_t* proc) {
+    return (uint32_t)(uintptr_t)proc->kstack + KSTACK_SIZE;
 }
 
 process_t* process_find(int pid) {
@@ -148,42 +208,70 @@ void process_yield(void) {
 
 void process_set_current(int pid) {
     current_pid = pid;
+    process_t* proc = process_find(pid);
+    if (proc) {
+        vdso_set_task(proc->tgid, proc->ppid);
+    }
+}
+
+/* Grace period over: no scheduler pass still sees the old occupant */
+static void process_reclaim(struct rcu_head* head) {
+    process_t* proc = (process_t*)((char*)head - offsetof(process_t, rcu));
+    if (proc->htas_info) {
+        kfree(proc->htas_info);
+        proc->htas_info = 0;
+    }
+    proc->reclaim_pending = false;
+}
+
+/* Another live task still runs in proc's page directory */
+static bool page_dir_shared(process_t* proc) {
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        process_t* p = &process_table[i];
+        if (p != proc && p->state != PROC_UNUSED && p->page_dir == proc->page_dir) {
+            return true;
+        }
+    }
+    return false;
 }
 
 void process_destroy(int pid) {
     process_t* proc = process_find(pid);
     if (!proc) return;
 
-    /* Free user address space resources (page tables, frames, etc.). */
-    if (proc->page_dir) {
+    htas_task_exit(proc);
+    wait_queue_cancel(proc);            // Its entry is on the stack being dropped
+    uring_release(pid);                 // Its rings live in the memory freed below
+
+    /* Free user address space resources (page tables, frames, etc.).
+       A thread's belong to its leader; a forked child shares its parent's
+       until clone_page_directory() copies, so the last user frees it. */
+    if (proc->page_dir && proc->tgid == proc->pid && !page_dir_shared(proc)) {
         free_user_address_space(proc->page_dir);
         proc->page_dir = 0;
     }
     
-    proc->state = PROC_UNUSED;
+    process_set_state(proc, PROC_UNUSED);
+    proc->reclaim_pending = true;
+    call_rcu(&proc->rcu, process_reclaim);
     
     printf("process: destroyed pid=%d\n", pid);
 }
 
-int process_fork(void) {
+int process_fork(struct registers* regs) {
     process_t* parent = process_current();
     if (!parent) {
         printf("process: fork failed - no current process\n");
         return -1;
     }
 
-    // Create child process
-    int child_pid = process_create(parent->pid);
-    if (child_pid < 0) {
-        printf("process: fork failed - no free slots\n");
-        return -1;
-    }
-
-    process_t* child = process_find(child_pid);
+    // Create child process (not runnable until its frame exists)
+    process_t* child = process_alloc(parent->pid);
     if (!child) {
-        printf("process: fork failed - couldn't find child\n");
+        printf("process: fork failed - no free slots\n");
         return -1;
     }
+    int child_pid = child->pid;
 
     // Clone page directory and memory
     child->page_dir = clone_page_directory(parent->page_dir);
@@ -193,15 +281,17 @@ int process_fork(void) {
         return -1;
     }
 
-    // Copy parent context to child
-    memcpy(&child->context, &parent->context, sizeof(proc_context_t));
-    
-    // Child returns 0 from fork
-    child->context.eax = 0;
-    
+    // The child starts as a copy of the parent's syscall frame, placed
+    // where the CPU would have pushed it on the child's own stack
+    struct registers* frame =
+        (struct registers*)(process_kstack_top(child) - sizeof(struct registers));
+    memcpy(frame, regs, sizeof(struct registers));
+    frame->eax = 0;                     // Child returns 0 from fork
+    child->kframe = frame;
+
     // Copy other process state
     child->brk = parent->brk;
-    child->state = PROC_READY;
+    process_set_state(child, PROC_READY);
 
     printf("process: fork: parent=%d child=%d\n", parent->pid, child_pid);
 
@@ -209,6 +299,50 @@ int process_fork(void) {
     return child_pid;
 }
 
+int process_clone(struct registers* regs, uint32_t entry, uint32_t stack, uint32_t tls) {
+    process_t* parent = process_current();
+    if (!parent || parent->kind != PROC_KIND_USER) {
+        printf("process: clone failed - no current user process\n");
+        return -1;
+    }
+
+    process_t* thread = process_alloc(parent->pid);
+    if (!thread) {
+        printf("process: clone failed - no free slots\n");
+        return -1;
+    }
+
+    thread->tgid = parent->tgid;
+    thread->page_dir = parent->page_dir;
+    thread->brk = parent->brk;
+    thread->tls_base = tls;
+    memcpy(thread->name, parent->name, sizeof(thread->name));
+
+    // Same user segments and flags as the caller, its own entry and stack
+    struct registers* frame =
+        (struct registers*)(process_kstack_top(thread) - sizeof(struct registers));
+    memcpy(frame, regs, sizeof(struct registers));
+    frame->eip = entry;
+    frame->useresp = stack;
+    frame->eax = 0;
+    thread->kframe = frame;
+    process_set_state(thread, PROC_READY);
+
+    // Hints are per thread from here on
+    if (parent->htas_info) {
+        sys_sched_set_profile((uint32_t)thread->pid, &parent->htas_info->profile);
+    }
+    return thread->pid;
+}
+
+void process_kill_threads(process_t* leader) {
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        process_t* p = &process_table[i];
+        if (p == leader || p->state == PROC_UNUSED || p->tgid != leader->pid) continue;
+        process_destroy(p->pid);
+    }
+}
+
 void process_exit(int code) {
     process_t* proc = process_current();
     if (!proc) {
@@ -217,7 +351,8 @@ void process_exit(int code) {
     }
 
     proc->exit_code = code;
-    proc->state = PROC_ZOMBIE;
+    process_set_state(proc, PROC_ZOMBIE);
+    htas_task_exit(proc);
     
     printf("process: pid=%d exited with code %d\n", proc->pid, code);
 
@@ -226,14 +361,14 @@ void process_exit(int code) {
         process_t* parent = process_find(proc->ppid);
         if (parent && parent->state == PROC_BLOCKED) {
             printf("process: waking up parent %d\n", proc->ppid);
-            parent->state = PROC_READY;
+            process_set_state(parent, PROC_READY);
         }
     }
 
     // TODO: Reparent children to init process
 }
 
-int process_wait(int* status) {
+int process_wait(int pid, int* status) {
     process_t* parent = process_current();
     if (!parent) {
         return -1;
@@ -244,14 +379,14 @@ int process_wait(int* status) {
         // Find any zombie child
         for (int i = 0; i < MAX_PROCESSES; i++) {
             process_t* p = &process_table[i];
-            if (p->state == PROC_ZOMBIE && p->ppid == parent->pid) {
-                int pid = p->pid;
+            if (p->state == PROC_ZOMBIE && p->ppid == parent->pid && (pid <= 0 || p->pid == pid)) {
+                int child = p->pid;
                 if (status) {
                     *status = p->exit_code;
                 }
-                process_destroy(pid);
-                printf("process: wait collected zombie child %d\n", pid);
-                return pid;
+                process_destroy(child);
+                printf("process: wait collected zombie child %d\n", child);
+                return child;
             }
         }
 
@@ -259,7 +394,8 @@ int process_wait(int* status) {
         int has_children = 0;
         for (int i = 0; i < MAX_PROCESSES; i++) {
             process_t* p = &process_table[i];
-            if (p->state != PROC_UNUSED && p->state != PROC_ZOMBIE && p->ppid == parent->pid) {
+            if (p->state != PROC_UNUSED && p->state != PROC_ZOMBIE && p->ppid == parent->pid &&
+                (pid <= 0 || p->pid == pid)) {
                 has_children = 1;
                 break;
             }
@@ -270,103 +406,115 @@ int process_wait(int* status) {
             return -1;
         }
 
-        // Has children but none are zombies - yield CPU
-        // The timer interrupt will switch to another process
-        // When we get scheduled again, we'll loop and check again
-        __asm__ volatile("hlt"); // Wait for next interrupt
+        // Has children but none are zombies: sleep on this process's own
+        // kernel stack until process_exit() makes us READY again. Entry
+        // through the syscall gate left interrupts off, so a child cannot
+        // exit between the scan above and the block.
+        htas_io_wait_begin(parent);
+        process_set_state(parent, PROC_BLOCKED);
+        idle_wait();
+        __asm__ volatile("cli");
+        if (parent->state == PROC_BLOCKED) {
+            process_set_state(parent, PROC_RUNNING);   // Woken by another IRQ
+        }
+        htas_io_wait_end(parent);
     }
 }
 
-void process_switch(int new_pid) {
-    if (new_pid == current_pid) return;
-
-    process_t* new_proc = process_find(new_pid);
-    if (!new_proc || new_proc->state != PROC_READY) {
-        printf("process: can't switch to pid=%d\n", new_pid);
-        return;
+/* A kthread that returned has nobody to wait() for it. Its stack holds
+   the frame being switched away from, but the slot is reused only after
+   the grace period this switch starts, by which time nothing runs on it. */
+static void reap_exited_kthread(process_t* current) {
+    if (current && current->kind == PROC_KIND_KTHREAD && current->state == PROC_ZOMBIE) {
+        process_destroy(current->pid);
     }
-
-    process_t* old_proc = process_current();
-    
-    // Save old process context (would be saved from interrupt/syscall)
-    if (old_proc && old_proc->state == PROC_RUNNING) {
-        old_proc->state = PROC_READY;
-    }
-
-    // Switch to new process
-    current_pid = new_pid;
-    new_proc->state = PROC_RUNNING;
-
-    // Switch page directory
-    write_cr3(new_proc->page_dir);
-
-    // Context would be restored by return from interrupt
 }
 
-/* Round-robin scheduler - pick next READY process */
-void process_schedule(struct registers* regs) {
-    process_t* current = process_current();
-    if (!current) {
-        return;
+/* Every tick, for kthreads and processes alike. The policy's pick is not
+   a single walk: htas_pick_next_process() charges, replenishes, picks
+   and ages in separate passes over the process table. */
+struct registers* process_schedule(struct registers* regs) {
+    // A kthread inside rcu_read_lock() keeps the CPU until it unlocks
+    if (rcu_read_lock_held()) {
+        return regs;
     }
 
-    bool was_running = (current->state == PROC_RUNNING);
+    process_t* current = process_current();
+    bool was_running = current && current->state == PROC_RUNNING;
 
+    // The interrupted task, blocked or not, is this frame on its own stack
+    if (current) {
+        current->kframe = regs;
+    } else if (idle_running) {
+        idle_frame = regs;
+    }
     if (was_running) {
-        current->context.eax = regs->eax;
-        current->context.ebx = regs->ebx;
-        current->context.ecx = regs->ecx;
-        current->context.edx = regs->edx;
-        current->context.esi = regs->esi;
-        current->context.edi = regs->edi;
-        current->context.ebp = regs->ebp;
-        current->context.esp = regs->useresp;
-        current->context.eip = regs->eip;
-        current->context.eflags = regs->eflags;
-        current->context.cs = regs->cs;
-        current->context.ss = regs->ss;
-        current->context.ds = regs->ds;
         current->state = PROC_READY;
     }
 
     process_t* next = htas_pick_next_process(current);
-    if (!next) {
+    if (!next || next == current || !state_is_runnable(next->state) || !next->kframe) {
         if (was_running) {
             current->state = PROC_RUNNING;
+            return regs;
         }
-        return;
-    }
-
-    if (next == current) {
-        current->state = PROC_RUNNING;
-        return;
-    }
-
-    if (next->state != PROC_READY && next->state != PROC_RUNNING) {
-        if (was_running) {
-            current->state = PROC_RUNNING;
+        if (!idle_frame) {
+            idle_frame = idle_task_frame();
         }
-        return;
+        if (!current || !idle_frame) {
+            return regs;
+        }
+
+        // Nothing can run: park the CPU in the idle task until a tick finds work
+        htas_record_switch(current, NULL);
+        reap_exited_kthread(current);
+        rcu_note_context_switch();
+        current_pid = -1;
+        idle_running = true;
+        vdso_set_task(0, 0);
+        return idle_frame;
     }
 
     htas_record_switch(current, next);
+    reap_exited_kthread(current);
+    rcu_note_context_switch();
 
+    idle_running = false;
     current_pid = next->pid;
     next->state = PROC_RUNNING;
+    vdso_set_task(next->tgid, next->ppid);
+
+    // Traps from ring 3 land on the new task's stack
+    if (next->kstack) {
+        tss_set_kernel_stack(process_kstack_top(next));
+    }
+    if (next->kind == PROC_KIND_USER) {
+        gdt_set_tls(next->tls_base);
+    }
+    // Kernel threads run in whatever address space was active
+    if (next->page_dir) {
+        write_cr3(next->page_dir);
+    }
 
-    write_cr3(next->page_dir);
-
-    regs->eax = next->context.eax;
-    regs->ebx = next->context.ebx;
-    regs->ecx = next->context.ecx;
-    regs->edx = next->context.edx;
-    regs->esi = next->context.esi;
-    regs->edi = next->context.edi;
-    regs->ebp = next->context.ebp;
-    regs->useresp = next->context.esp;
-    regs->eip = next->context.eip;
-    regs->eflags = next->context.eflags;
-    regs->cs = next->context.cs;
-    regs->ss = next->context.ss;
-    regs->ds = next->context.ds;
+    return next->kframe;
+}
+
+void process_ps(void) {
+    static const char* state_names[] = {"UNUSED", "READY", "RUNNING", "BLOCKED", "ZOMBIE"};
+
+    printf("PID PPID STATE USER SYS P-CORE E-CORE WAIT IOWAIT (ms) NAME\n");
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        process_t* p = &process_table[i];
+        if (p->state == PROC_UNUSED) continue;
+
+        proc_times_t t;
+        htas_acct_get(p, &t);
+        printf("%d %d %s %u %u %u %u %u %u %s%s\n",
+               p->pid, p->ppid, state_names[p->state],
+               (uint32_t)(t.user_us / 1000), (uint32_t)(t.sys_us / 1000),
+               (uint32_t)(t.pcore_us / 1000), (uint32_t)(t.ecore_us / 1000),
+               (uint32_t)(t.wait_us / 1000), (uint32_t)(t.iowait_us / 1000),
+               p->name[0] ? p->name : "(user)",
+               (p->pid == current_pid) ? " *" : "");
+    }
 }
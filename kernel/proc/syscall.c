@@ -8,8 +8,12 @@
 #include <kernel/pmm.h>
 #include <kernel/vmm.h>
 #include <kernel/process.h>
+#include <kernel/uring.h>
+#include <kernel/idle.h>
+#include <kernel/gdt.h>
+#include <kernel/futex.h>
 
-static int sys_write_impl(const char* buf, unsigned len) {
+int syscall_console_write(const char* buf, unsigned len) {
     /* Mirror userland stdout to BOTH serial and VGA so output is visible
        in the QEMU window and (optionally) on the host terminal. */
     for (unsigned i = 0; i < len; ++i) {
@@ -30,15 +34,89 @@ extern int fs_write(int fd, const void* buf, unsigned len);
 extern int fs_close(int fd);
 extern int fs_dump_list(char* buf, unsigned len);
 
+#define USER_LIMIT 0xC0000000u
+
+/* A buffer from a user caller must lie wholly below the kernel; kernel
+   callers (kthreads, the boot context) may pass kernel addresses */
+static bool user_buf_ok(process_t* caller, const void* p, uint32_t len) {
+    if (!p) return false;
+    if (!caller || caller->kind != PROC_KIND_USER) return true;
+    uint32_t addr = (uint32_t)p;
+    return addr < USER_LIMIT && len <= USER_LIMIT - addr;
+}
+
+/* pid 0 is the caller. A user caller may only name threads of its own
+   process; kernel callers may name anyone. */
+static process_t* target_proc(process_t* caller, int pid) {
+    process_t* proc = pid ? process_find(pid) : caller;
+    if (!proc) return 0;
+    if (caller && caller->kind == PROC_KIND_USER && proc->tgid != caller->tgid) return 0;
+    return proc;
+}
+
+static int sys_proc_times_impl(process_t* caller, int pid, proc_times_t* out) {
+    process_t* proc = target_proc(caller, pid);
+    if (!proc || !user_buf_ok(caller, out, sizeof(*out))) return -1;
+    htas_acct_get(proc, out);
+    return 0;
+}
+
+/* Hint calls take pid 0 for the caller and a buffer of len bytes at p;
+   the target's pid, or -1 */
+static int hint_pid(process_t* caller, int pid, const void* p, uint32_t len) {
+    process_t* proc = target_proc(caller, pid);
+    if (!proc || !user_buf_ok(caller, p, len)) return -1;
+    return proc->pid;
+}
+
+static int sys_set_profile_impl(process_t* caller, int pid, const task_profile_t* profile) {
+    int target = hint_pid(caller, pid, profile, sizeof(*profile));
+    return target < 0 ? -1 : sys_sched_set_profile((uint32_t)target, profile);
+}
+
+static int sys_get_profile_impl(process_t* caller, int pid, task_profile_t* out) {
+    int target = hint_pid(caller, pid, out, sizeof(*out));
+    return target < 0 ? -1 : sys_sched_get_profile((uint32_t)target, out);
+}
+
+static int sys_set_affinity_impl(process_t* caller, int pid, const cpumask_t* mask) {
+    int target = hint_pid(caller, pid, mask, sizeof(*mask));
+    return target < 0 ? -1 : sys_sched_set_affinity((uint32_t)target, *mask);
+}
+
+static int sys_get_affinity_impl(process_t* caller, int pid, cpumask_t* out) {
+    int target = hint_pid(caller, pid, out, sizeof(*out));
+    return target < 0 ? -1 : sys_sched_get_affinity((uint32_t)target, out);
+}
+
+static int sys_get_stats_impl(process_t* caller, int pid, htas_task_stats_t* out) {
+    int target = hint_pid(caller, pid, out, sizeof(*out));
+    return target < 0 ? -1 : sys_sched_get_stats((uint32_t)target, out);
+}
+
 void syscall_dispatch(struct registers* regs) {
+    process_t* caller = process_current();
+    htas_acct_syscall_enter(caller);
+
     switch (regs->eax) {
         case SYS_write:
               /* Quiet default: avoid per-call spam so user shells are readable. */
-              regs->eax = (uint32_t)sys_write_impl((const char*)regs->ebx, (unsigned)regs->ecx);
+              regs->eax = (uint32_t)syscall_console_write((const char*)regs->ebx, (unsigned)regs->ecx);
             break;
         case SYS_exit: {
             int code = (int)regs->ebx;
             printf("\n[usr] exit(%d)\n", code);
+            /* A forked child stays a zombie on its own stack until its
+               parent's wait() reaps it; only the process started by
+               run_user_and_wait() returns to the kernel caller. */
+            process_t* self = process_current();
+            if (self && self->tgid == self->pid) {
+                process_kill_threads(self);     // They run in memory freed with it
+            }
+            if (self && self->ppid != KERNEL_PID) {
+                process_exit(code);
+                for (;;) { __asm__ volatile("sti; hlt"); }
+            }
             /* Save exit code and arrange to return control at the ISR tail. */
             if (!proc_prepare_kernel_return(regs, code)) {
                 printf("[sys_exit] ERROR: proc_prepare_kernel_return failed!\n");
@@ -69,7 +147,12 @@ void syscall_dispatch(struct registers* regs) {
                 __asm__ volatile("sti" ::: "memory");
                 while (n < len) {
                     int ch = kbd_getch();
-                    if (ch < 0) { __asm__ volatile("sti; hlt"); continue; }
+                    if (ch < 0) {
+                        htas_io_wait_begin(process_current());
+                        idle_wait();
+                        htas_io_wait_end(process_current());
+                        continue;
+                    }
                     if (ch == '\r') ch = '\n';
                     if (ch == '\b') {
                         if (n > 0) { n--; terminal_putchar('\b'); terminal_putchar(' '); terminal_putchar('\b'); }
@@ -122,50 +205,75 @@ void syscall_dispatch(struct registers* regs) {
             regs->eax = (uint32_t)fs_dump_list((char*)regs->ebx, (unsigned)regs->ecx);
             break;
         case SYS_fork: {
-            // Save current process context from interrupt frame
-            process_t* proc = process_current();
-            if (proc) {
-                // Update current process context with register state
-                proc->context.eax = regs->eax;
-                proc->context.ebx = regs->ebx;
-                proc->context.ecx = regs->ecx;
-                proc->context.edx = regs->edx;
-                proc->context.esi = regs->esi;
-                proc->context.edi = regs->edi;
-                proc->context.ebp = regs->ebp;
-                proc->context.esp = regs->useresp;
-                proc->context.eip = regs->eip;
-                proc->context.eflags = regs->eflags;
-                proc->context.cs = regs->cs;
-                proc->context.ss = regs->ss;
-                proc->context.ds = regs->ds;
-                // Set default segment values for es, fs, gs
-                proc->context.es = 0x23;
-                proc->context.fs = 0x23;
-                proc->context.gs = 0x23;
-            }
-            int child_pid = process_fork();
+            // The child resumes from a copy of this frame
+            int child_pid = process_fork(regs);
             regs->eax = (uint32_t)child_pid;
             break;
         }
         case SYS_wait: {
             int* status = (int*)regs->ebx;
-            int pid = process_wait(status);
+            int pid = process_wait((int)regs->ecx, status);
             regs->eax = (uint32_t)pid;
             break;
         }
-        case SYS_getpid: {
-            // For now, just return a fake PID without process management
-            regs->eax = 1; // Always return PID 1
+        case SYS_getpid:
+            regs->eax = caller ? (uint32_t)caller->tgid : 0;
             break;
-        }
-        case SYS_getppid: {
-            // For now, just return a fake PPID without process management
-            regs->eax = 0; // Always return PPID 0
+        case SYS_gettid:
+            regs->eax = caller ? (uint32_t)caller->pid : 0;
+            break;
+        case SYS_clone:
+            regs->eax = (uint32_t)process_clone(regs, regs->ebx, regs->ecx, regs->edx);
+            break;
+        case SYS_set_tls:
+            if (caller) {
+                caller->tls_base = regs->ebx;
+                gdt_set_tls(caller->tls_base);  // gs reloads on the way out
+            }
+            regs->eax = caller ? 0 : (uint32_t)-1;
+            break;
+        case SYS_getppid:
+            regs->eax = caller ? (uint32_t)caller->ppid : 0;
+            break;
+        case SYS_uring_setup:
+            regs->eax = (uint32_t)uring_setup((uring_t*)regs->ebx, regs->ecx, regs->edx);
+            break;
+        case SYS_uring_enter:
+            regs->eax = (uint32_t)uring_enter((int)regs->ebx, regs->ecx);
+            break;
+        case SYS_futex_wait:
+            regs->eax = (uint32_t)futex_wait(regs->ebx, regs->ecx);
+            break;
+        case SYS_futex_wake:
+            regs->eax = (uint32_t)futex_wake(regs->ebx, (int)regs->ecx);
+            break;
+        case SYS_sched_set_profile:
+            regs->eax = (uint32_t)sys_set_profile_impl(caller, (int)regs->ebx,
+                                                       (const task_profile_t*)regs->ecx);
+            break;
+        case SYS_sched_get_profile:
+            regs->eax = (uint32_t)sys_get_profile_impl(caller, (int)regs->ebx,
+                                                       (task_profile_t*)regs->ecx);
+            break;
+        case SYS_sched_set_affinity:
+            regs->eax = (uint32_t)sys_set_affinity_impl(caller, (int)regs->ebx,
+                                                        (const cpumask_t*)regs->ecx);
+            break;
+        case SYS_sched_get_affinity:
+            regs->eax = (uint32_t)sys_get_affinity_impl(caller, (int)regs->ebx,
+                                                        (cpumask_t*)regs->ecx);
+            break;
+        case SYS_sched_get_stats:
+            regs->eax = (uint32_t)sys_get_stats_impl(caller, (int)regs->ebx,
+                                                     (htas_task_stats_t*)regs->ecx);
+            break;
+        case SYS_proc_times:
+            regs->eax = (uint32_t)sys_proc_times_impl(caller, (int)regs->ebx, (proc_times_t*)regs->ecx);
             break;
-        }
         default:
             printf("Unknown syscall: %u\n", regs->eax);
             regs->eax = (uint32_t)-1;
     }
+
+    htas_acct_syscall_exit(caller);
 }
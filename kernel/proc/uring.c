@@ -0,0 +1,192 @@
+#include <kernel/uring.h>
+#include <kernel/process.h>
+#include <kernel/sched.h>
+#include <kernel/syscall.h>
+#include <kernel/fs.h>
+#include <kernel/vmm.h>
+#include <kernel/stdio.h>
+#include <stdbool.h>
+
+#define USER_LIMIT 0xC0000000u
+#define URING_PATH_MAX 256              /* OPEN path, terminator included */
+
+typedef struct {
+    uring_t* ring;                      // NULL: slot free
+    uint32_t entries;                   // Ring geometry as set up; the user can rewrite ring->entries
+    uint32_t mask;
+    int owner;                          // pid
+    int poller;                         // SQPOLL kthread pid, or -1
+} uring_slot_t;
+
+static uring_slot_t s_slots[URING_MAX_RINGS];
+
+static inline uring_sqe_t* sq_entries(uring_t* ring) {
+    return (uring_sqe_t*)(ring + 1);
+}
+
+static inline uring_cqe_t* cq_entries(const uring_slot_t* slot) {
+    return (uring_cqe_t*)(sq_entries(slot->ring) + slot->entries);
+}
+
+static bool user_range_ok(uint32_t addr, uint32_t len) {
+    return addr < USER_LIMIT && len <= USER_LIMIT - addr;
+}
+
+/* A path ends within URING_PATH_MAX bytes, below the kernel, on mapped
+   pages: the byte reads below must not fault, least of all in the poller */
+static bool user_string_ok(uint32_t addr) {
+    for (uint32_t i = 0; i < URING_PATH_MAX; i++, addr++) {
+        if (addr >= USER_LIMIT) return false;
+        if ((i == 0 || (addr & 0xFFFu) == 0) && !vmm_resolve(addr)) return false;
+        if (*(const char*)addr == 0) return true;
+    }
+    return false;
+}
+
+static int32_t execute(const uring_sqe_t* sqe) {
+    if (sqe->flags) return -1;
+
+    switch (sqe->opcode) {
+        case URING_OP_NOP:
+            return 0;
+        case URING_OP_READ:
+            if (sqe->fd < 3) return -1;         // Console input: SYS_read
+            if (!user_range_ok(sqe->addr, sqe->len)) return -1;
+            return fs_read(sqe->fd, (void*)sqe->addr, sqe->len);
+        case URING_OP_WRITE:
+            if (!user_range_ok(sqe->addr, sqe->len)) return -1;
+            if (sqe->fd == 1 || sqe->fd == 2) {
+                return syscall_console_write((const char*)sqe->addr, sqe->len);
+            }
+            return fs_write(sqe->fd, (const void*)sqe->addr, sqe->len);
+        case URING_OP_OPEN:
+            if (!user_string_ok(sqe->addr)) return -1;
+            return fs_open((const char*)sqe->addr);
+        case URING_OP_CLOSE:
+            return fs_close(sqe->fd);
+        default:
+            return -1;
+    }
+}
+
+/* Consume one submission. 1: done, 0: SQ empty or CQ full. Callers
+   keep interrupts off, like the syscall path the operations come from. */
+static int consume_one(const uring_slot_t* slot) {
+    uring_t* ring = slot->ring;
+    uint32_t mask = slot->mask;
+    uint32_t head = ring->sq_head;
+    uint32_t tail = __atomic_load_n(&ring->sq_tail, __ATOMIC_ACQUIRE);
+    uint32_t cq_tail = ring->cq_tail;
+
+    if (head == tail) return 0;
+    if (cq_tail - __atomic_load_n(&ring->cq_head, __ATOMIC_ACQUIRE) >= slot->entries) return 0;
+
+    uring_sqe_t sqe = sq_entries(ring)[head & mask];   // The user may reuse the slot
+    __atomic_store_n(&ring->sq_head, head + 1, __ATOMIC_RELEASE);
+
+    uring_cqe_t* cqe = &cq_entries(slot)[cq_tail & mask];
+    cqe->user_data = sqe.user_data;
+    cqe->res = execute(&sqe);
+    __atomic_store_n(&ring->cq_tail, cq_tail + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+/* SQPOLL: drain the ring, then sleep until the next tick. Each entry runs
+   with interrupts off so it never interleaves with a syscall in the
+   (non-reentrant) filesystem; uring_release() destroys this thread
+   between entries, never inside one. */
+static void poller_main(void* arg) {
+    uring_slot_t* slot = (uring_slot_t*)arg;
+
+    for (;;) {
+        __asm__ volatile("cli");
+        int done = slot->ring ? consume_one(slot) : 0;
+        __asm__ volatile("sti");
+        if (!done) {
+            sched_yield();
+        }
+    }
+}
+
+int uring_setup(uring_t* ring, uint32_t entries, uint32_t flags) {
+    process_t* owner = process_current();
+    uint32_t base = (uint32_t)ring;
+
+    if (!owner || !ring || entries == 0 || entries > URING_MAX_ENTRIES ||
+        (entries & (entries - 1)) || (flags & ~URING_SETUP_SQPOLL)) {
+        return -1;
+    }
+    if (base >= USER_LIMIT || URING_SIZE(entries) > USER_LIMIT - base) {
+        return -1;
+    }
+
+    int id = -1;
+    for (int i = 0; i < URING_MAX_RINGS; i++) {
+        if (!s_slots[i].ring) { id = i; break; }
+    }
+    if (id < 0) {
+        printf("uring: no free ring slots\n");
+        return -1;
+    }
+
+    ring->sq_head = ring->sq_tail = 0;
+    ring->cq_head = ring->cq_tail = 0;
+    ring->entries = entries;
+    ring->flags = flags;
+
+    uring_slot_t* slot = &s_slots[id];
+    slot->entries = entries;
+    slot->mask = entries - 1;
+    slot->owner = owner->pid;
+    slot->poller = -1;
+    if (flags & URING_SETUP_SQPOLL) {
+        int pid = kthread_create(poller_main, slot, "uring-poll");
+        process_t* poller = process_find(pid);
+        if (!poller) {
+            printf("uring: cannot start poller\n");
+            return -1;
+        }
+        poller->page_dir = owner->page_dir;     // Runs in the owner's address space
+        slot->poller = pid;
+    }
+    slot->ring = ring;
+    return id;
+}
+
+int uring_enter(int id, uint32_t to_submit) {
+    process_t* caller = process_current();
+    if (id < 0 || id >= URING_MAX_RINGS || !caller) return -1;
+
+    uring_slot_t* slot = &s_slots[id];
+    if (!slot->ring || slot->owner != caller->pid) return -1;
+    if (slot->poller >= 0) return 0;            // The poller owns the SQ
+
+    uint32_t done = 0;
+    while (done < to_submit && consume_one(slot)) {
+        done++;
+    }
+    return (int)done;
+}
+
+void uring_release(int pid) {
+    for (int i = 0; i < URING_MAX_RINGS; i++) {
+        uring_slot_t* slot = &s_slots[i];
+        if (!slot->ring || slot->owner != pid) continue;
+
+        // Callers may already run with interrupts off (wait() reaping)
+        uint32_t eflags;
+        __asm__ volatile("pushfl; popl %0; cli" : "=r"(eflags) :: "memory");
+        slot->ring = 0;
+        if (slot->poller >= 0) {
+            process_t* poller = process_find(slot->poller);
+            if (poller) {
+                poller->page_dir = 0;           // The owner's, freed by the owner
+                process_destroy(poller->pid);
+            }
+            slot->poller = -1;
+        }
+        if (eflags & 0x200) {
+            __asm__ volatile("sti");
+        }
+    }
+}
@@ -0,0 +1,79 @@
+#include <kernel/vdso.h>
+#include <kernel/vmm.h>
+#include <kernel/tsc.h>
+#include <kernel/pit.h>
+#include <kernel/stdio.h>
+#include <stdbool.h>
+
+#define KERNEL_VIRT_BASE 0xC0000000u
+
+_Static_assert(sizeof(vdso_data_t) <= 4096, "vdso data fits its page");
+
+/* Written through the kernel mapping; user space sees the same frame */
+static union {
+    vdso_data_t data;
+    uint8_t page[4096];
+} s_vdso __attribute__((aligned(4096)));
+
+static bool s_have_tsc = false;
+
+static inline void write_begin(void) {
+    s_vdso.data.seq++;
+    __asm__ volatile("" ::: "memory");
+}
+
+static inline void write_end(void) {
+    __asm__ volatile("" ::: "memory");
+    s_vdso.data.seq++;
+}
+
+int vdso_init(void) {
+    vdso_data_t* d = &s_vdso.data;
+    uint32_t khz = tsc_khz();
+
+    s_have_tsc = tsc_available();
+
+    write_begin();
+    d->version = VDSO_VERSION;
+    d->tick_hz = pit_hz();
+    d->tsc_mult = s_have_tsc ? (uint32_t)((1000000ull << VDSO_SHIFT) / khz) : 0;
+    d->tsc_base = s_have_tsc ? tsc_read() : 0;
+    d->ns_base = 0;
+    d->ticks = pit_ticks();
+    d->pid = 0;
+    d->ppid = 0;
+    write_end();
+
+    uint32_t phys = (uint32_t)&s_vdso - KERNEL_VIRT_BASE;
+    if (vmm_map(VDSO_ADDR, phys, PAGE_USER) != 0) {
+        printf("vdso: cannot map page at 0x%x\n", VDSO_ADDR);
+        return -1;
+    }
+    printf("vdso: page at 0x%x, %s clock\n", VDSO_ADDR, s_have_tsc ? "TSC" : "tick");
+    return 0;
+}
+
+/* Rebase every tick so (tsc - tsc_base) * tsc_mult stays far from
+   overflow; user readers extrapolate from the same base, so the clock
+   never steps backwards */
+void vdso_tick(void) {
+    vdso_data_t* d = &s_vdso.data;
+
+    write_begin();
+    if (s_have_tsc) {
+        uint64_t now = tsc_read();
+        d->ns_base += ((now - d->tsc_base) * d->tsc_mult) >> VDSO_SHIFT;
+        d->tsc_base = now;
+    } else if (d->tick_hz) {
+        d->ns_base += 1000000000u / d->tick_hz;
+    }
+    d->ticks = pit_ticks();
+    write_end();
+}
+
+void vdso_set_task(int pid, int ppid) {
+    write_begin();
+    s_vdso.data.pid = pid;
+    s_vdso.data.ppid = ppid;
+    write_end();
+}
@@ -3,137 +3,180 @@
 #include <kernel/tty.h>
 #include <kernel/kmalloc.h>
 #include <kernel/stdio.h>
+#include <kernel/pit.h>
+#include <kernel/tsc.h>
+#include <kernel/trace.h>
+#include <kernel/lock.h>
 #include <string.h>
 
-cpu_info_t g_cpu_topology[NUM_CPUS] = {
-    { .cpu_id = 0, .type = CPU_TYPE_PCORE, .numa_node = 0, .online = true },
-    { .cpu_id = 1, .type = CPU_TYPE_PCORE, .numa_node = 0, .online = true },
-    { .cpu_id = 2, .type = CPU_TYPE_ECORE, .numa_node = 1, .online = true },
-    { .cpu_id = 3, .type = CPU_TYPE_ECORE, .numa_node = 1, .online = true },
-};
-
-numa_region_t g_numa_regions[NUM_NUMA_NODES] = {
-    { .base = 0x00000000, .size = 0x08000000 },
-    { .base = 0x08000000, .size = 0x08000000 },
-};
-
 static scheduler_type_t g_current_scheduler = SCHED_BASELINE;
 static uint8_t g_current_cpu = 0;
 static uint64_t g_tick_counter = 0;
 
 static scheduler_stats_t* active_stats(void) {
-    return (g_current_scheduler == SCHED_BASELINE)
-            ? &g_baseline_stats : &g_htas_stats;
+    switch (g_current_scheduler) {
+        case SCHED_BASELINE: return &g_baseline_stats;
+        case SCHED_FAIR:     return &g_fair_stats;
+        case SCHED_DYNAMIC:  return &g_dynamic_stats;
+        default:             return &g_htas_stats;
+    }
 }
 
 scheduler_stats_t g_baseline_stats;
 scheduler_stats_t g_htas_stats;
+scheduler_stats_t g_fair_stats;
+scheduler_stats_t g_dynamic_stats;
+
+uint32_t htas_tick_us(void) {
+    uint32_t hz = pit_hz();
+    return hz ? (1000000u / hz) : 10000u;
+}
 
 void htas_init(void) {
     printf("hint-BASED Topology-Aware Scheduler SIMULATOR caus i suck at x64\n");
-    printf("[HTAS] Topology Map:\n");
-    
-    for (int i = 0; i < NUM_CPUS; i++) {
-        const char* type_str = (g_cpu_topology[i].type == CPU_TYPE_PCORE) ? "P-Core" : "E-Core";
-        printf("[HTAS]   CPU %d: %s, NUMA Node %d\n", 
-               i, type_str, g_cpu_topology[i].numa_node);
-    }
-    
-    printf("[HTAS] NUMA Regions:\n");
-    for (int i = 0; i < NUM_NUMA_NODES; i++) {
-        printf("[HTAS]   Node %d: 0x%08x - 0x%08x\n",
-               i, g_numa_regions[i].base, 
-               g_numa_regions[i].base + g_numa_regions[i].size);
-    }
+    htas_topology_init();
+    htas_numa_init();
+    htas_topology_print();
+    htas_numa_print();
     
     memset(&g_baseline_stats, 0, sizeof(scheduler_stats_t));
     memset(&g_htas_stats, 0, sizeof(scheduler_stats_t));
+    memset(&g_fair_stats, 0, sizeof(scheduler_stats_t));
+    memset(&g_dynamic_stats, 0, sizeof(scheduler_stats_t));
     
     g_current_scheduler = SCHED_BASELINE;
+    htas_slice_init();
     printf("[HTAS] Active scheduler: BASELINE (Round-Robin)\n");
 }
 
 void htas_set_scheduler(scheduler_type_t type) {
     g_current_scheduler = type;
-    
-    const char* name = "UNKNOWN";
-    switch (type) {
-        case SCHED_BASELINE:
-            name = "BASELINE";
-            break;
-        case SCHED_HTAS:
-            name = "HTAS";
-            break;
-        case SCHED_DYNAMIC:
-            name = "DYNAMIC";
-            break;
-    }
-    
-    printf("[HTAS] Switched to %s scheduler\n", name);
+    htas_slice_init();
+    printf("[HTAS] Switched to %s scheduler\n", htas_scheduler_name(type));
 }
 
 scheduler_type_t htas_get_scheduler(void) {
     return g_current_scheduler;
 }
 
+const char* htas_scheduler_name(scheduler_type_t type) {
+    switch (type) {
+        case SCHED_BASELINE: return "BASELINE";
+        case SCHED_HTAS:     return "HTAS";
+        case SCHED_DYNAMIC:  return "DYNAMIC";
+        case SCHED_FAIR:     return "FAIR";
+    }
+    return "UNKNOWN";
+}
+
+task_intent_t htas_task_intent(struct process* proc) {
+    if (!proc) return PROFILE_DEFAULT;
+    if (!proc->htas_info) {
+        // Unhinted: DYNAMIC places it by what it has been observed doing
+        return (g_current_scheduler == SCHED_DYNAMIC)
+             ? proc->se.inferred_intent : PROFILE_DEFAULT;
+    }
+    task_intent_t intent = proc->htas_info->profile.intent;
+    if ((int)intent < 0 || intent > PROFILE_DEFAULT) {
+        intent = PROFILE_DEFAULT;
+    }
+    return intent;
+}
+
+/* TSC time, so deadlines and budgets resolve below a tick (PIT ticks
+   when there is no usable TSC) */
+uint64_t htas_now_us(void) {
+    return tsc_cycles_to_us(tsc_read());
+}
+
+void htas_enqueue_task(struct process* proc) {
+    // The FAIR queue is maintained under every policy so that switching
+    // to it at runtime starts from a consistent tree.
+    htas_fair_enqueue(proc);
+    htas_dl_enqueue(proc);
+    htas_acct_wakeup(proc);
+    htas_slice_wakeup(proc);
+    trace_event(g_current_cpu, TRACE_WAKEUP, (uint16_t)proc->pid,
+                (uint16_t)htas_task_intent(proc), 0);
+}
+
+void htas_dequeue_task(struct process* proc) {
+    htas_fair_dequeue(proc);
+    htas_dl_dequeue(proc);
+}
+
+void htas_task_init(struct process* proc) {
+    memset(&proc->se, 0, sizeof(htas_entity_t));
+    proc->se.inferred_intent = PROFILE_DEFAULT;
+    htas_wl_task_start(proc);
+}
+
+void htas_task_exit(struct process* proc) {
+    htas_acct_exit(proc);
+    htas_wl_task_exit(proc);
+    htas_dl_release(proc);
+}
+
 cpu_type_t htas_get_cpu_type(uint8_t cpu_id) {
-    if (cpu_id >= NUM_CPUS) return CPU_TYPE_PCORE;
+    if (cpu_id >= g_num_cpus) return CPU_TYPE_PCORE;
     return g_cpu_topology[cpu_id].type;
 }
 
 uint8_t htas_get_numa_node_for_cpu(uint8_t cpu_id) {
-    if (cpu_id >= NUM_CPUS) return 0;
+    if (cpu_id >= g_num_cpus) return 0;
     return g_cpu_topology[cpu_id].numa_node;
 }
 
-uint8_t htas_get_numa_node_for_address(void* addr) {
-    uint32_t address = (uint32_t)addr;
-    
-    for (int i = 0; i < NUM_NUMA_NODES; i++) {
-        uint32_t base = g_numa_regions[i].base;
-        uint32_t end = base + g_numa_regions[i].size;
-        
-        if (address >= base && address < end) {
-            return i;
-        }
+/* printf has no 64-bit conversions */
+static void print_cpumask(cpumask_t mask) {
+    const char* digits = "0123456789abcdef";
+    int shift = 60;
+    while (shift > 0 && ((mask >> shift) & 0xF) == 0) {
+        shift -= 4;
+    }
+    printf("0x");
+    for (; shift >= 0; shift -= 4) {
+        printf("%c", digits[(mask >> shift) & 0xF]);
     }
-    
-    return 0;
 }
 
-uint32_t htas_calculate_affinity(const task_profile_t* profile) {
-    uint32_t mask = 0;
+static cpumask_t online_mask(void) {
+    return (g_num_cpus >= 64) ? ~(cpumask_t)0 : CPUMASK_BIT(g_num_cpus) - 1;
+}
+
+cpumask_t htas_calculate_affinity(const task_profile_t* profile) {
+    cpumask_t mask = 0;
     
     switch (profile->intent) {
         case PROFILE_PERFORMANCE:
         case PROFILE_LOW_LATENCY:
-            for (int i = 0; i < NUM_CPUS; i++) {
+            for (int i = 0; i < g_num_cpus; i++) {
                 if (g_cpu_topology[i].type == CPU_TYPE_PCORE) {
-                    mask |= (1 << i);
+                    mask |= CPUMASK_BIT(i);
                 }
             }
             break;
             
         case PROFILE_EFFICIENCY:
-            for (int i = 0; i < NUM_CPUS; i++) {
+            for (int i = 0; i < g_num_cpus; i++) {
                 if (g_cpu_topology[i].type == CPU_TYPE_ECORE) {
-                    mask |= (1 << i);
+                    mask |= CPUMASK_BIT(i);
                 }
             }
             break;
             
         case PROFILE_DEFAULT:
-            mask = (1 << NUM_CPUS) - 1;
+            mask = online_mask();
             break;
     }
     
     if (profile->primary_data_region != NULL) {
         uint8_t numa_node = htas_get_numa_node_for_address(profile->primary_data_region);
-        uint32_t numa_mask = 0;
+        cpumask_t numa_mask = 0;
         
-        for (int i = 0; i < NUM_CPUS; i++) {
+        for (int i = 0; i < g_num_cpus; i++) {
             if (g_cpu_topology[i].numa_node == numa_node) {
-                numa_mask |= (1 << i);
+                numa_mask |= CPUMASK_BIT(i);
             }
         }
         
@@ -152,11 +195,11 @@ uint32_t htas_calculate_affinity(const task_profile_t* profile) {
 }
 
 bool htas_can_run_on_cpu(struct process* proc, uint8_t cpu_id) {
-    if (cpu_id >= NUM_CPUS) return false;
-    if (!proc->htas_info) return true;
+    if (cpu_id >= g_num_cpus) return false;
+    htas_task_info_t* info = rcu_dereference(proc->htas_info);
+    if (!info) return true;
     
-    uint32_t mask = proc->htas_info->cpu_affinity_mask;
-    return (mask & (1 << cpu_id)) != 0;
+    return (info->cpu_affinity_mask & CPUMASK_BIT(cpu_id)) != 0;
 }
 
 int sys_sched_set_profile(uint32_t pid, const task_profile_t* profile) {
@@ -165,47 +208,153 @@ int sys_sched_set_profile(uint32_t pid, const task_profile_t* profile) {
         printf("[HTAS] sys_sched_set_profile: PID %d not found\n", pid);
         return -1;
     }
+    if (!profile || (uint32_t)profile->intent > PROFILE_DEFAULT) {
+        printf("[HTAS] sys_sched_set_profile: invalid profile\n");
+        return -1;
+    }
     
-    // Allocate HTAS info if not present
-    if (!proc->htas_info) {
-        proc->htas_info = kmalloc(sizeof(htas_task_info_t));
-        if (!proc->htas_info) {
+    // Fields change in place with interrupts off: the scheduler reads them
+    // from the tick, and RCU only covers publishing the pointer once.
+    // Allocation comes before admission so that a failed allocation cannot
+    // leave bandwidth reserved.
+    uint32_t flags = irq_save();
+    htas_task_info_t* info = proc->htas_info;
+    bool fresh = (info == NULL);
+    if (fresh) {
+        info = kmalloc(sizeof(htas_task_info_t));
+        if (!info) {
+            irq_restore(flags);
             printf("[HTAS] sys_sched_set_profile: Out of memory\n");
             return -1;
         }
-        memset(proc->htas_info, 0, sizeof(htas_task_info_t));
+        memset(info, 0, sizeof(htas_task_info_t));
+    }
+
+    // Reserve deadline bandwidth before touching the profile, so a
+    // rejected request changes nothing
+    if (htas_dl_admit(proc, profile) != 0) {
+        irq_restore(flags);
+        if (fresh) {
+            kfree(info);
+        }
+        return -1;
     }
     
     // Copy profile
-    memcpy(&proc->htas_info->profile, profile, sizeof(task_profile_t));
+    memcpy(&info->profile, profile, sizeof(task_profile_t));
     
     // Calculate CPU affinity mask
-    proc->htas_info->cpu_affinity_mask = htas_calculate_affinity(profile);
+    info->cpu_affinity_mask = htas_calculate_affinity(profile);
     
     // Set priority boost for LOW_LATENCY tasks
     if (profile->intent == PROFILE_LOW_LATENCY) {
-        proc->htas_info->priority_boost = LOW_LATENCY_PRIORITY_BOOST;
+        info->priority_boost = LOW_LATENCY_PRIORITY_BOOST;
     } else {
-        proc->htas_info->priority_boost = 0;
+        info->priority_boost = 0;
     }
     
     // Calculate preferred NUMA node
     if (profile->primary_data_region != NULL) {
-        proc->htas_info->preferred_numa_node = 
+        info->preferred_numa_node = 
             htas_get_numa_node_for_address(profile->primary_data_region);
     } else {
-        proc->htas_info->preferred_numa_node = 0;
+        info->preferred_numa_node = 0;
+    }
+
+    if (fresh) {
+        rcu_assign_pointer(proc->htas_info, info);
     }
+    irq_restore(flags);
     
+    trace_event(g_current_cpu, TRACE_PROFILE, (uint16_t)pid, (uint16_t)profile->intent,
+                (uint16_t)proc->htas_info->cpu_affinity_mask);
+
     const char* intent_name[] = {"PERFORMANCE", "EFFICIENCY", "LOW_LATENCY", "DEFAULT"};
-    printf("[HTAS] PID %d set profile: %s, affinity=0x%x, NUMA node=%d\n",
-           pid, intent_name[profile->intent], 
-           proc->htas_info->cpu_affinity_mask,
-           proc->htas_info->preferred_numa_node);
+    printf("[HTAS] PID %d set profile: %s, affinity=", pid, intent_name[profile->intent]);
+    print_cpumask(proc->htas_info->cpu_affinity_mask);
+    printf(", NUMA node=%d\n", proc->htas_info->preferred_numa_node);
+
+    if (proc->se.dl_admitted) {
+        printf("[HTAS] PID %d deadline reservation: %u/%u us, deadline %u us (total util %u per mille)\n",
+               pid, profile->dl_runtime_us, profile->dl_period_us,
+               profile->dl_deadline_us ? profile->dl_deadline_us : profile->dl_period_us,
+               htas_dl_total_util_permille());
+        if (proc->state == PROC_READY || proc->state == PROC_RUNNING) {
+            htas_dl_enqueue(proc);
+        }
+    }
     
     return 0;
 }
 
+int sys_sched_get_profile(uint32_t pid, task_profile_t* out) {
+    process_t* proc = process_find(pid);
+    if (!proc || !out) return -1;
+
+    htas_task_info_t* info = rcu_dereference(proc->htas_info);
+    if (info) {
+        memcpy(out, &info->profile, sizeof(task_profile_t));
+    } else {
+        memset(out, 0, sizeof(task_profile_t));
+        out->intent = PROFILE_DEFAULT;
+    }
+    return 0;
+}
+
+int sys_sched_set_affinity(uint32_t pid, cpumask_t mask) {
+    process_t* proc = process_find(pid);
+    if (!proc) return -1;
+
+    mask &= online_mask();
+    if (!mask) {
+        printf("[HTAS] sys_sched_set_affinity: no online CPU in mask\n");
+        return -1;
+    }
+    if (!proc->htas_info) {
+        task_profile_t profile = { .intent = PROFILE_DEFAULT };
+        if (sys_sched_set_profile(pid, &profile) != 0) return -1;
+    }
+
+    uint32_t flags = irq_save();
+    proc->htas_info->cpu_affinity_mask = mask;
+    irq_restore(flags);
+
+    trace_event(g_current_cpu, TRACE_PROFILE, (uint16_t)pid,
+                (uint16_t)proc->htas_info->profile.intent, (uint16_t)mask);
+    return 0;
+}
+
+int sys_sched_get_affinity(uint32_t pid, cpumask_t* out) {
+    process_t* proc = process_find(pid);
+    if (!proc || !out) return -1;
+
+    htas_task_info_t* info = rcu_dereference(proc->htas_info);
+    *out = info ? info->cpu_affinity_mask : online_mask();
+    return 0;
+}
+
+int sys_sched_get_stats(uint32_t pid, htas_task_stats_t* out) {
+    process_t* proc = process_find(pid);
+    if (!proc || !out) return -1;
+
+    proc_times_t t;
+    htas_acct_get(proc, &t);
+    htas_task_info_t* info = rcu_dereference(proc->htas_info);
+
+    memset(out, 0, sizeof(*out));
+    out->intent = htas_task_intent(proc);
+    out->preferred_numa_node = info ? info->preferred_numa_node : 0;
+    out->affinity = info ? info->cpu_affinity_mask : online_mask();
+    out->runtime_us = t.user_us + t.sys_us;
+    out->pcore_us = t.pcore_us;
+    out->ecore_us = t.ecore_us;
+    out->wait_us = t.wait_us;
+    out->voluntary_switches = proc->se.nvcsw;
+    out->involuntary_switches = proc->se.nivcsw;
+    out->numa_penalties = info ? info->numa_penalties : 0;
+    return 0;
+}
+
 /* ============================================================================
  * E-CORE SLOWDOWN SIMULATION
  * ============================================================================ */
@@ -223,19 +372,23 @@ static void simulate_ecore_slowdown(uint8_t cpu_id) {
  * ============================================================================ */
 
 void htas_simulate_memory_access(struct process* proc, void* addr, uint32_t size) {
-    if (!proc || !proc->htas_info) return;
-    
+    if (!proc) return;
+
     uint8_t memory_numa = htas_get_numa_node_for_address(addr);
+    htas_dyn_memory_access(proc, memory_numa);
+
+    if (!proc->htas_info) return;
+
     uint8_t cpu_numa = htas_get_numa_node_for_cpu(g_current_cpu);
     
     if (memory_numa != cpu_numa) {
-        for (volatile int i = 0; i < NUMA_PENALTY_CYCLES; i++);
+        int spin = NUMA_PENALTY_CYCLES *
+                   (htas_numa_distance(cpu_numa, memory_numa) - NUMA_LOCAL_DISTANCE) / 10;
+        for (volatile int i = 0; i < spin; i++);
         
         proc->htas_info->numa_penalties++;
         
-        scheduler_stats_t* stats = (g_current_scheduler == SCHED_BASELINE) 
-                                    ? &g_baseline_stats : &g_htas_stats;
-        stats->numa_penalties++;
+        active_stats()->numa_penalties++;
     }
 }
 
@@ -285,10 +438,13 @@ struct process* baseline_select_next(void) {
     return NULL;
 }
 
+/* Lock-free scan: slots and their htas_info stay valid until a grace
+   period after process_destroy() */
 struct process* htas_select_next(uint8_t cpu_id) {
     process_t* best = NULL;
     int best_priority = -1000;
     
+    rcu_read_lock();
     process_t* processes = process_get_list();
     for (int i = 0; i < MAX_PROCESSES; i++) {
         process_t* proc = &processes[i];
@@ -310,11 +466,9 @@ struct process* htas_select_next(uint8_t cpu_id) {
             // *** NEW: Add boost from priority aging ***
             priority += proc->htas_info->priority_boost_aging;
             
-            // Add boost for NUMA locality
+            // Add boost for NUMA locality, less the further away the CPU is
             uint8_t cpu_numa = htas_get_numa_node_for_cpu(cpu_id);
-            if (proc->htas_info->preferred_numa_node == cpu_numa) {
-                priority += 5;
-            }
+            priority += htas_numa_score(proc->htas_info->preferred_numa_node, cpu_numa, 5, 0);
         }
         
         if (priority > best_priority || !best) {
@@ -322,10 +476,21 @@ struct process* htas_select_next(uint8_t cpu_id) {
             best = proc;
         }
     }
+    rcu_read_unlock();
     
     return best;
 }
 
+/* Time since the last pick: what current ran for, as every switch
+   happens here */
+static uint32_t dl_ran_us(void) {
+    static uint64_t last_us = 0;
+    uint64_t now = htas_now_us();
+    uint64_t ran = last_us ? now - last_us : htas_tick_us();
+    last_us = now;
+    return ran > 0xFFFFFFFFu ? 0xFFFFFFFFu : (uint32_t)ran;
+}
+
 struct process* htas_pick_next_process(struct process* current) {
     g_tick_counter++;
 
@@ -334,16 +499,44 @@ struct process* htas_pick_next_process(struct process* current) {
 
     process_t* next = NULL;
 
-    // 1. Select the next process to run
-    if (g_current_scheduler == SCHED_BASELINE) {
-        next = baseline_select_next();
-    } else {
-        next = htas_select_next(g_current_cpu);
+    trace_event(g_current_cpu, TRACE_TICK, current ? (uint16_t)current->pid : 0,
+                (uint16_t)pit_ticks(), 0);
+
+    // Charge the tick that just ended to whoever was running it
+    htas_acct_tick(current);
+    htas_dyn_tick(current);
+    htas_fair_charge(current, htas_tick_us());
+    htas_dl_charge(current, dl_ran_us());
+    htas_dl_replenish();
+    htas_slice_tick();
+
+    // 1. Select the next process to run. Admitted deadline reservations
+    //    run ahead of every policy, earliest deadline first; then the
+    //    running task finishes its slice.
+    next = htas_dl_select_next(g_current_cpu);
+    bool kept = false;
+    if (!next && htas_slice_keep(current)) {
+        next = current;
+        kept = true;
+    }
+    if (!next) {
+        if (g_current_scheduler == SCHED_BASELINE) {
+            next = baseline_select_next();
+        } else if (g_current_scheduler == SCHED_FAIR) {
+            next = htas_fair_select_next(g_current_cpu);
+        } else if (g_current_scheduler == SCHED_DYNAMIC) {
+            next = htas_dyn_select_next(g_current_cpu);
+        } else {
+            next = htas_select_next(g_current_cpu);
+        }
     }
 
     if (!next) {
         return current; // No runnable processes found
     }
+    if (!kept) {
+        htas_slice_start(next);
+    }
 
     // --- NEW: PRIORITY AGING LOOP ---
     // 2. Age all other ready tasks that were *not* selected
@@ -372,14 +565,30 @@ struct process* htas_pick_next_process(struct process* current) {
     return next;
 }
 
+/* next is NULL when the CPU goes to the idle task */
 void htas_record_switch(process_t* current, process_t* next) {
-    if (!next || next == current) {
+    if (next == current) {
         return;
     }
 
     scheduler_stats_t* stats = active_stats();
     stats->context_switches++;
 
+    trace_event(g_current_cpu, TRACE_SWITCH, current ? (uint16_t)current->pid : 0,
+                next ? (uint16_t)next->pid : 0, current ? (uint16_t)current->state : 0);
+    if (!next) {
+        htas_acct_switch(current, NULL, g_current_cpu);
+        return;
+    }
+    bool has_run = (next->se.pcore_cycles | next->se.ecore_cycles) != 0;
+    if (has_run && next->se.acct_cpu != g_current_cpu) {
+        trace_event(g_current_cpu, TRACE_MIGRATE, (uint16_t)next->pid,
+                    next->se.acct_cpu, g_current_cpu);
+    }
+
+    htas_dyn_switch(current);
+    htas_acct_switch(current, next, g_current_cpu);
+
     if (next->htas_info) {
         // --- NEW: RESET AGING COUNTERS ---
         // The task is now running, so reset its wait time and aging boost
@@ -388,24 +597,12 @@ void htas_record_switch(process_t* current, process_t* next) {
         // --- END NEW ---
 
         next->htas_info->total_switches++;
-        task_intent_t intent = next->htas_info->profile.intent;
-        if ((int)intent < 0 || intent > PROFILE_DEFAULT) {
-            intent = PROFILE_DEFAULT;
-        }
-        stats->intent_stats[intent].switches++;
+        stats->intent_stats[htas_task_intent(next)].switches++;
     }
 
     simulate_ecore_slowdown(g_current_cpu);
 
-    if (htas_get_cpu_type(g_current_cpu) == CPU_TYPE_PCORE) {
-        stats->total_power_consumption += 100;
-        stats->pcore_time_us += 10;
-    } else {
-        stats->total_power_consumption += 40;
-        stats->ecore_time_us += 10;
-    }
-
-    g_current_cpu = (g_current_cpu + 1) % NUM_CPUS;
+    g_current_cpu = (g_current_cpu + 1) % g_num_cpus;
 }
 
 /* ============================================================================
@@ -413,16 +610,52 @@ void htas_record_switch(process_t* current, process_t* next) {
  * ============================================================================ */
 
 scheduler_stats_t* htas_get_stats(void) {
-    return (g_current_scheduler == SCHED_BASELINE) 
-            ? &g_baseline_stats : &g_htas_stats;
+    return active_stats();
 }
 
 void htas_reset_stats(void) {
     memset(&g_baseline_stats, 0, sizeof(scheduler_stats_t));
     memset(&g_htas_stats, 0, sizeof(scheduler_stats_t));
+    memset(&g_fair_stats, 0, sizeof(scheduler_stats_t));
+    memset(&g_dynamic_stats, 0, sizeof(scheduler_stats_t));
     printf("[HTAS] Statistics reset\n");
 }
 
+void htas_latency_record(scheduler_stats_t* stats, task_intent_t intent, uint32_t latency_us) {
+    uint32_t bucket = 0;
+    for (uint32_t v = latency_us; v && bucket < LAT_HIST_BUCKETS - 1; v >>= 1) {
+        bucket++;
+    }
+
+    stats->intent_stats[intent].latency_hist[bucket]++;
+    stats->intent_stats[intent].latency_samples++;
+    stats->intent_stats[intent].latency_total_us += latency_us;
+    stats->intent_stats[intent].avg_latency_us =
+        stats->intent_stats[intent].latency_total_us / stats->intent_stats[intent].latency_samples;
+    if (latency_us > stats->intent_stats[intent].max_jitter_us) {
+        stats->intent_stats[intent].max_jitter_us = latency_us;
+    }
+}
+
+uint32_t htas_latency_percentile(const scheduler_stats_t* stats, task_intent_t intent,
+                                 uint32_t permille) {
+    uint64_t samples = stats->intent_stats[intent].latency_samples;
+    if (samples == 0) return 0;
+
+    uint64_t rank = (samples * permille + 999) / 1000;
+    uint64_t seen = 0;
+    uint32_t max = (uint32_t)stats->intent_stats[intent].max_jitter_us;
+
+    for (uint32_t b = 0; b < LAT_HIST_BUCKETS; b++) {
+        seen += stats->intent_stats[intent].latency_hist[b];
+        if (seen >= rank) {
+            uint32_t upper = (b == 0) ? 0 : (1u << b) - 1;
+            return (upper < max) ? upper : max;
+        }
+    }
+    return max;
+}
+
 void htas_print_stats(scheduler_stats_t* stats, const char* name) {
     printf("\n========================================\n");
     printf(" %s SCHEDULER STATISTICS\n", name);
@@ -434,6 +667,9 @@ void htas_print_stats(scheduler_stats_t* stats, const char* name) {
     printf("P-core time:           %u us\n", (uint32_t)stats->pcore_time_us);
     printf("E-core time:           %u us\n", (uint32_t)stats->ecore_time_us);
     printf("Power consumption:     %u units\n", (uint32_t)stats->total_power_consumption);
+    if (stats->fairness_permille > 0) {
+        printf("Fairness index:        %u / 1000\n", stats->fairness_permille);
+    }
     
     printf("\nPer-Intent Statistics:\n");
     const char* intent_names[] = {"PERFORMANCE", "EFFICIENCY", "LOW_LATENCY", "DEFAULT"};
@@ -444,12 +680,22 @@ void htas_print_stats(scheduler_stats_t* stats, const char* name) {
             printf("    Runtime:      %u us\n", (uint32_t)stats->intent_stats[i].runtime_us);
             printf("    Switches:     %u\n", (uint32_t)stats->intent_stats[i].switches);
             
-            if (i == PROFILE_LOW_LATENCY) {
+            if (stats->intent_stats[i].latency_samples > 0) {
                 printf("    Avg Latency:  %u us\n", (uint32_t)stats->intent_stats[i].avg_latency_us);
-                printf("    Max Jitter:   %u us\n", (uint32_t)stats->intent_stats[i].max_jitter_us);
+                printf("    Wakeup Latency: p50 %u / p90 %u / p99 %u / max %u us (%u samples)\n",
+                       htas_latency_percentile(stats, i, 500),
+                       htas_latency_percentile(stats, i, 900),
+                       htas_latency_percentile(stats, i, 990),
+                       (uint32_t)stats->intent_stats[i].max_jitter_us,
+                       (uint32_t)stats->intent_stats[i].latency_samples);
             }
         }
     }
+
+    if (stats->deadline_jobs > 0) {
+        printf("\nDeadline misses:       %u / %u jobs\n",
+               (uint32_t)stats->deadline_misses, (uint32_t)stats->deadline_jobs);
+    }
     
     printf("========================================\n\n");
 }
@@ -492,6 +738,22 @@ void htas_compare_stats(scheduler_stats_t* stats_a, const char* name_a,
            name_a, (uint32_t)stats_a->intent_stats[PROFILE_LOW_LATENCY].max_jitter_us);
     printf("  %s Max Jitter: %u us\n",
            name_b, (uint32_t)stats_b->intent_stats[PROFILE_LOW_LATENCY].max_jitter_us);
+    printf("  %s Latency p50/p99: %u / %u us\n", name_a,
+           htas_latency_percentile(stats_a, PROFILE_LOW_LATENCY, 500),
+           htas_latency_percentile(stats_a, PROFILE_LOW_LATENCY, 990));
+    printf("  %s Latency p50/p99: %u / %u us\n", name_b,
+           htas_latency_percentile(stats_b, PROFILE_LOW_LATENCY, 500),
+           htas_latency_percentile(stats_b, PROFILE_LOW_LATENCY, 990));
+
+    printf("  %s Deadline Misses: %u / %u jobs\n", name_a,
+           (uint32_t)stats_a->deadline_misses, (uint32_t)stats_a->deadline_jobs);
+    printf("  %s Deadline Misses: %u / %u jobs\n", name_b,
+           (uint32_t)stats_b->deadline_misses, (uint32_t)stats_b->deadline_jobs);
+
+    // Weighted fairness (Jain's index, 1000 = perfectly proportional)
+    printf("\nFairness Index (per mille):\n");
+    printf("  %s: %u\n", name_a, stats_a->fairness_permille);
+    printf("  %s: %u\n", name_b, stats_b->fairness_permille);
     
     printf("========================================\n\n");
 }
\ No newline at end of file
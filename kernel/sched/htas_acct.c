@@ -0,0 +1,188 @@
+/* HTAS CPU time accounting
+ *
+ * Each process has at most one open interval (acct_stamp). Whatever ends it
+ * (timer tick, context switch, syscall entry/exit, I/O wait, exit) charges
+ * the elapsed TSC cycles to user or system time and to the core type of the
+ * simulated CPU it ran on, then opens the next one. Time spent runnable but
+ * not picked is wait time; time blocked in read/wait is I/O wait.
+ *
+ * The per-process buckets stay in cycles so nothing is lost to rounding;
+ * the scheduler-wide stats (core time, per-intent runtime, power) are fed
+ * in microseconds as each interval closes.
+ */
+
+#include <kernel/htas.h>
+#include <kernel/process.h>
+#include <kernel/tsc.h>
+
+/* Power draw per ms of busy CPU, same units as the simulator */
+#define POWER_PCORE_PER_MS 120
+#define POWER_ECORE_PER_MS 70
+
+/* Idle draw per ms until the idle governor has measured residency */
+#define POWER_PCORE_IDLE_PER_MS 30
+#define POWER_ECORE_IDLE_PER_MS 20
+
+static uint64_t s_idle_us = 0;          // Measured idle residency
+static uint64_t s_idle_energy = 0;      // Sum of us x P-core draw of the state
+
+static inline bool is_runnable(process_t* proc) {
+    return proc->state == PROC_READY || proc->state == PROC_RUNNING;
+}
+
+static void close_interval(process_t* proc, uint64_t now) {
+    htas_entity_t* se = &proc->se;
+    if (!se->acct_on_cpu) return;
+
+    uint64_t delta = now - se->acct_stamp;
+    se->acct_stamp = now;
+    if (delta == 0) return;
+
+    if (se->acct_in_kernel) {
+        se->sys_cycles += delta;
+    } else {
+        se->user_cycles += delta;
+    }
+
+    bool pcore = (htas_get_cpu_type(se->acct_cpu) == CPU_TYPE_PCORE);
+    if (pcore) {
+        se->pcore_cycles += delta;
+    } else {
+        se->ecore_cycles += delta;
+    }
+
+    uint32_t us = (uint32_t)tsc_cycles_to_us(delta);
+    scheduler_stats_t* stats = htas_get_stats();
+    if (pcore) {
+        stats->pcore_time_us += us;
+        stats->total_power_consumption += ((uint64_t)us * POWER_PCORE_PER_MS) / 1000;
+    } else {
+        stats->ecore_time_us += us;
+        stats->total_power_consumption += ((uint64_t)us * POWER_ECORE_PER_MS) / 1000;
+    }
+    stats->intent_stats[htas_task_intent(proc)].runtime_us += us;
+    if (proc->htas_info) {
+        proc->htas_info->total_runtime_us += us;
+    }
+}
+
+static void open_interval(process_t* proc, uint64_t now, uint8_t cpu_id) {
+    htas_entity_t* se = &proc->se;
+
+    if (se->ready_stamp) {
+        se->wait_cycles += now - se->ready_stamp;
+        se->ready_stamp = 0;
+    }
+
+    // First run since the READY transition: wakeup latency sample
+    if (se->wakeup_stamp) {
+        htas_latency_record(htas_get_stats(), htas_task_intent(proc),
+                            (uint32_t)tsc_cycles_to_us(now - se->wakeup_stamp));
+        se->wakeup_stamp = 0;
+    }
+
+    se->acct_cpu = cpu_id;
+    se->acct_stamp = now;
+    se->acct_on_cpu = !se->io_waiting;
+}
+
+void htas_acct_tick(struct process* current) {
+    if (!current || !is_runnable(current)) return;
+
+    uint64_t now = tsc_read();
+    if (current->se.acct_on_cpu) {
+        close_interval(current, now);
+    } else if (!current->se.io_waiting) {
+        // First tick of a process that was started without a switch
+        open_interval(current, now, current->se.acct_cpu);
+    }
+}
+
+void htas_acct_switch(struct process* prev, struct process* next, uint8_t cpu_id) {
+    uint64_t now = tsc_read();
+
+    if (prev) {
+        close_interval(prev, now);
+        prev->se.acct_on_cpu = false;
+        if (is_runnable(prev) && !prev->se.io_waiting) {
+            prev->se.ready_stamp = now;
+        }
+    }
+
+    if (next) {
+        open_interval(next, now, cpu_id);
+    }
+}
+
+void htas_acct_wakeup(struct process* proc) {
+    uint64_t now = tsc_read();
+    if (!proc->se.ready_stamp) {
+        proc->se.ready_stamp = now;
+    }
+    proc->se.wakeup_stamp = now;
+}
+
+void htas_acct_syscall_enter(struct process* proc) {
+    if (!proc) return;
+    close_interval(proc, tsc_read());
+    proc->se.acct_in_kernel = true;
+}
+
+void htas_acct_syscall_exit(struct process* proc) {
+    if (!proc) return;
+    close_interval(proc, tsc_read());
+    proc->se.acct_in_kernel = false;
+}
+
+void htas_acct_io_begin(struct process* proc) {
+    uint64_t now = tsc_read();
+    close_interval(proc, now);
+    proc->se.acct_on_cpu = false;
+    proc->se.io_stamp = now;
+}
+
+void htas_acct_io_end(struct process* proc) {
+    uint64_t now = tsc_read();
+    htas_entity_t* se = &proc->se;
+
+    se->iowait_cycles += now - se->io_stamp;
+    // The wait ends in the process's own context, so it is on a CPU again
+    se->acct_stamp = now;
+    se->acct_on_cpu = true;
+}
+
+void htas_acct_exit(struct process* proc) {
+    close_interval(proc, tsc_read());
+    proc->se.acct_on_cpu = false;
+    proc->se.ready_stamp = 0;
+}
+
+void htas_acct_get(struct process* proc, struct proc_times* out) {
+    const htas_entity_t* se = &proc->se;
+
+    out->user_us = tsc_cycles_to_us(se->user_cycles);
+    out->sys_us = tsc_cycles_to_us(se->sys_cycles);
+    out->pcore_us = tsc_cycles_to_us(se->pcore_cycles);
+    out->ecore_us = tsc_cycles_to_us(se->ecore_cycles);
+    out->wait_us = tsc_cycles_to_us(se->wait_cycles);
+    out->iowait_us = tsc_cycles_to_us(se->iowait_cycles);
+}
+
+static uint32_t ecore_idle_power(uint32_t pcore_power) {
+    return pcore_power * POWER_ECORE_IDLE_PER_MS / POWER_PCORE_IDLE_PER_MS;
+}
+
+void htas_acct_idle(uint8_t cpu_id, uint32_t us, uint32_t power_per_ms) {
+    bool pcore = (htas_get_cpu_type(cpu_id) == CPU_TYPE_PCORE);
+    uint32_t power = pcore ? power_per_ms : ecore_idle_power(power_per_ms);
+
+    htas_get_stats()->total_power_consumption += ((uint64_t)us * power) / 1000;
+    s_idle_us += us;
+    s_idle_energy += (uint64_t)us * power_per_ms;
+}
+
+uint32_t htas_idle_power_per_ms(cpu_type_t type) {
+    uint32_t pcore = s_idle_us ? (uint32_t)(s_idle_energy / s_idle_us) : POWER_PCORE_IDLE_PER_MS;
+    if (type == CPU_TYPE_PCORE) return pcore;
+    return s_idle_us ? ecore_idle_power(pcore) : POWER_ECORE_IDLE_PER_MS;
+}
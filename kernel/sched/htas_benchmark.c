@@ -1,8 +1,12 @@
 /* HTAS Benchmark - Mixed Workload Test
- * * This file now compares THREE schedulers:
+ * * This file now compares FOUR schedulers:
  * 1. BASELINE: Simple, topology-unaware Round-Robin.
  * 2. HTAS (Hint-Based): Topology-aware, uses explicit hints.
  * 3. DYNAMIC: Topology-aware, uses *inferred* behavior (no hints).
+ * 4. FAIR: Weighted fair-share, smallest virtual runtime first.
+ *
+ * Any of them can additionally run with the DEADLINE (EDF/CBS) class on top,
+ * which serves the LOW_LATENCY reservation before the policy picks.
  */
 
 #include <kernel/htas.h>
@@ -10,6 +14,8 @@
 #include <kernel/pit.h>
 #include <kernel/stdio.h>
 #include <kernel/kmalloc.h>
+#include <kernel/serial.h>
+#include <kernel/tty.h>
 #include <string.h>
 #include <stdbool.h>
 
@@ -25,12 +31,18 @@ static uint8_t* g_numa_buffer = NULL;
  * ============================================================================ */
 
 #define SIM_TICK_US 1000
-#define SIM_TASK_COUNT 8
+#define SIM_TASK_COUNT 8   // Size of the built-in mix (replicated up to task_count)
+#define SIM_DEFAULT_CPUS 4 // Fixed benchmarks keep the 2P+2E demo layout on any host
+#define SIM_DEFAULT_NUMA_NODES 2
 
 // --- NEW: Dynamic Scheduler Constants ---
 #define DYNAMIC_INFERENCE_WINDOW 50 // Ticks to average load over
 #define DYNAMIC_LOAD_THRESHOLD 25   // Ticks in window to be a 'PERFORMANCE' task
 
+// LOW_LAT deadline reservation: 2ms of work due 4ms after release, every 16ms
+#define SIM_DL_RUNTIME_MS  2
+#define SIM_DL_DEADLINE_MS 4
+
 typedef struct {
     const char* name;
     task_intent_t intent;
@@ -61,27 +73,75 @@ typedef struct {
     uint32_t recent_cpu_ticks; // How many ticks has this run in the last N?
     uint8_t inferred_numa_node; // Which NUMA node does it *seem* to access?
     bool inferred_numa_locked; // Has its NUMA preference been detected?
+
+    // --- FAIR Tracking ---
+    uint64_t vruntime;         // Weighted runtime (us * 1024 / weight)
+    uint32_t ready_ticks;      // Ticks spent runnable, for the fairness index
+
+    // --- DEADLINE Tracking ---
+    uint32_t dl_runtime_ms;    // Reserved budget per period (0 = no reservation)
+    uint32_t dl_deadline_ms;   // Relative deadline of each job
+    uint32_t dl_budget;        // Budget left in the current period
+    uint32_t job_release_tick; // Tick the current job became ready
+
+    // --- REPLAY (recorded workload, see htas_workload.c) ---
+    const wl_task_t* replay;   // NULL for the built-in tasks
+    uint16_t replay_phase;     // Next phase to load
+    uint32_t replay_block_left;
     
 } sim_task_t;
 
-typedef struct {
-    sim_task_t tasks[SIM_TASK_COUNT];
-    int last_task_on_cpu[NUM_CPUS];
-    uint64_t latency_total_us;
-    uint32_t latency_samples;
-    uint32_t latency_max_us;
+/* Everything one simulation run touches lives here, so runs with separate
+ * contexts are independent of each other and of the live scheduler. */
+struct sim_context {
+    sim_config_t cfg;
+    cpu_type_t cpu_type[SIM_MAX_CPUS];
+    uint8_t cpu_numa[SIM_MAX_CPUS];
+
+    sim_task_t tasks[SIM_MAX_TASKS];
+    int task_count;
+    int last_task_on_cpu[SIM_MAX_CPUS];
     uint32_t tick;
     int rr_index;
-    
-    // NEW: Stats for the dynamic scheduler
-    scheduler_stats_t dynamic_stats;
-} sim_context_t;
+    uint64_t fair_min_vruntime;
+};
 
-static void sim_init_tasks(sim_context_t* ctx) {
+/* Too big for the 16KB kernel stack at SIM_MAX_TASKS; the shell runs one
+ * benchmark at a time, so its entry points share this one. */
+static sim_context_t g_sim_ctx;
+
+sim_context_t* htas_sim_context_alloc(void) {
+    return (sim_context_t*)kmalloc(sizeof(sim_context_t));
+}
+
+/* The configuration every fixed benchmark uses: the demo topology (2 P-cores
+ * on node 0, 2 E-cores on node 1) and the 8-task demo mix. */
+static void sim_default_config(sim_config_t* cfg, uint32_t duration_ms) {
+    *cfg = (sim_config_t){
+        .duration_ms = duration_ms,
+        .task_count = SIM_TASK_COUNT,
+        .num_cpus = SIM_DEFAULT_CPUS,
+        .num_pcores = 2,
+        .numa_nodes = SIM_DEFAULT_NUMA_NODES,
+        .effi_duty_cycle = 5,
+        .aging_threshold = AGING_THRESHOLD,
+        .aging_boost = AGING_PRIORITY_BOOST,
+    };
+}
+
+static void sim_init_context(sim_context_t* ctx, const sim_config_t* cfg) {
     memset(ctx, 0, sizeof(sim_context_t));
-    for (int cpu = 0; cpu < NUM_CPUS; ++cpu) {
+    ctx->cfg = *cfg;
+
+    for (int cpu = 0; cpu < cfg->num_cpus; ++cpu) {
+        ctx->cpu_type[cpu] = (cpu < cfg->num_pcores) ? CPU_TYPE_PCORE : CPU_TYPE_ECORE;
+        ctx->cpu_numa[cpu] = (uint8_t)((cpu * cfg->numa_nodes) / cfg->num_cpus);
         ctx->last_task_on_cpu[cpu] = -1;
     }
+}
+
+static void sim_init_tasks(sim_context_t* ctx) {
+    const sim_config_t* cfg = &ctx->cfg;
 
     ctx->tasks[0] = (sim_task_t){
         .name = "PERF0",
@@ -109,7 +169,7 @@ static void sim_init_tasks(sim_context_t* ctx) {
             .preferred_type = CPU_TYPE_ECORE,
             .preferred_numa = 1,
             .base_priority = 10,  // <-- SET TO 10
-            .duty_cycle = 5,
+            .duty_cycle = cfg->effi_duty_cycle,
             .active_ticks = 1,
             .inferred_numa_node = 0,
         };
@@ -125,6 +185,8 @@ static void sim_init_tasks(sim_context_t* ctx) {
         .work_ms = 2,
         .time_since_release = 16,
         .inferred_numa_node = 0,
+        .dl_runtime_ms = SIM_DL_RUNTIME_MS,
+        .dl_deadline_ms = SIM_DL_DEADLINE_MS,
     };
 
     ctx->tasks[7] = (sim_task_t){
@@ -135,16 +197,82 @@ static void sim_init_tasks(sim_context_t* ctx) {
         .base_priority = 10,  // <-- SET TO 10
         .inferred_numa_node = 0, 
     };
+
+    // Larger scenarios replicate the mix, rotating each copy's home node
+    ctx->task_count = (cfg->task_count < SIM_MAX_TASKS) ? cfg->task_count : SIM_MAX_TASKS;
+    for (int i = 0; i < ctx->task_count; ++i) {
+        if (i >= SIM_TASK_COUNT) {
+            ctx->tasks[i] = ctx->tasks[i % SIM_TASK_COUNT];
+        }
+        sim_task_t* task = &ctx->tasks[i];
+        task->preferred_numa = (uint8_t)((task->preferred_numa + i / SIM_TASK_COUNT) % cfg->numa_nodes);
+    }
+}
+
+/* Build the task set from a recorded workload instead of the built-in mix.
+ * Recorded hints map to the same placement preferences as the built-in
+ * tasks; unhinted (DEFAULT) tasks get no core-type preference. */
+static void sim_init_replay(sim_context_t* ctx) {
+    static const char* replay_names[WL_MAX_TASKS] = {
+        "T0", "T1", "T2", "T3", "T4", "T5", "T6", "T7",
+        "T8", "T9", "T10", "T11", "T12", "T13", "T14", "T15",
+    };
+    const wl_trace_t* trace = ctx->cfg.replay;
+
+    ctx->task_count = (trace->ntasks < WL_MAX_TASKS) ? trace->ntasks : WL_MAX_TASKS;
+
+    for (int i = 0; i < ctx->task_count; ++i) {
+        const wl_task_t* wl = &trace->tasks[i];
+        task_intent_t intent = (task_intent_t)wl->intent;
+
+        ctx->tasks[i] = (sim_task_t){
+            .name = replay_names[i],
+            .intent = intent,
+            .preferred_type = (intent == PROFILE_EFFICIENCY) ? CPU_TYPE_ECORE : CPU_TYPE_PCORE,
+            .preferred_numa = (uint8_t)(wl->numa % ctx->cfg.numa_nodes),
+            .base_priority = 10,
+            .inferred_numa_node = 0,
+            .replay = wl,
+        };
+    }
+}
+
+/* Advance a replayed task: not ready before its arrival, then each phase is
+ * run_ms of CPU work followed by block_ms asleep. */
+static void sim_replay_prepare(sim_context_t* ctx, sim_task_t* task) {
+    const wl_task_t* wl = task->replay;
+
+    task->ready = false;
+    if (ctx->tick < wl->arrival_ms) {
+        return;
+    }
+
+    if (task->work_remaining == 0 && task->replay_block_left > 0) {
+        task->replay_block_left--;
+        return;
+    }
+
+    while (task->work_remaining == 0 && task->replay_block_left == 0 &&
+           task->replay_phase < wl->nphases) {
+        const wl_phase_t* phase = &wl->phases[task->replay_phase++];
+        task->work_ms = phase->run_ms;
+        task->work_remaining = phase->run_ms;
+        task->replay_block_left = phase->block_ms;
+    }
+
+    task->ready = (task->work_remaining > 0);
 }
 
 static void sim_prepare_tick(sim_context_t* ctx) {
-    // (This function remains unchanged)
-    for (int i = 0; i < SIM_TASK_COUNT; ++i) {
+    for (int i = 0; i < ctx->task_count; ++i) {
         sim_task_t* task = &ctx->tasks[i];
+        bool was_ready = task->ready;
         task->selected_this_tick = false;
         task->scheduled_this_tick = false;
 
-        if (task->intent == PROFILE_LOW_LATENCY) {
+        if (task->replay) {
+            sim_replay_prepare(ctx, task);
+        } else if (task->intent == PROFILE_LOW_LATENCY) {
             if (task->work_remaining == 0) {
                 if (task->time_since_release < task->period_ms) {
                     task->time_since_release++;
@@ -153,6 +281,8 @@ static void sim_prepare_tick(sim_context_t* ctx) {
                     if (task->work_remaining == 0 && !task->ready) {
                         task->work_remaining = task->work_ms;
                         task->waiting_since_ready = 0;
+                        task->job_release_tick = ctx->tick;
+                        task->dl_budget = task->dl_runtime_ms;
                     }
                     task->ready = (task->work_remaining > 0);
                 }
@@ -165,17 +295,29 @@ static void sim_prepare_tick(sim_context_t* ctx) {
         } else {
             task->ready = true;
         }
+
+        if (task->ready) {
+            task->ready_ticks++;
+            // FAIR wakeup placement: bounded credit for time spent asleep
+            if (!was_ready) {
+                uint64_t floor = ctx->fair_min_vruntime;
+                floor = (floor > FAIR_WAKEUP_CREDIT_US) ? floor - FAIR_WAKEUP_CREDIT_US : 0;
+                if (task->vruntime < floor) {
+                    task->vruntime = floor;
+                }
+            }
+        }
     }
 }
 
 /* --- SCHEDULER 1: BASELINE (Round-Robin) --- */
 static int sim_select_task_round_robin(sim_context_t* ctx) {
     // (This function remains unchanged)
-    for (int attempts = 0; attempts < SIM_TASK_COUNT; ++attempts) {
-        int idx = (ctx->rr_index + attempts) % SIM_TASK_COUNT;
+    for (int attempts = 0; attempts < ctx->task_count; ++attempts) {
+        int idx = (ctx->rr_index + attempts) % ctx->task_count;
         sim_task_t* task = &ctx->tasks[idx];
         if (task->ready && !task->selected_this_tick) {
-            ctx->rr_index = (idx + 1) % SIM_TASK_COUNT;
+            ctx->rr_index = (idx + 1) % ctx->task_count;
             task->selected_this_tick = true;
             return idx;
         }
@@ -188,10 +330,10 @@ static int sim_select_task_htas(sim_context_t* ctx, int cpu_id) {
     // (This function remains unchanged)
     int best_idx = -1;
     int best_score = -1000;
-    cpu_type_t cpu_type = g_cpu_topology[cpu_id].type;
-    uint8_t cpu_numa = g_cpu_topology[cpu_id].numa_node;
+    cpu_type_t cpu_type = ctx->cpu_type[cpu_id];
+    uint8_t cpu_numa = ctx->cpu_numa[cpu_id];
 
-    for (int i = 0; i < SIM_TASK_COUNT; ++i) {
+    for (int i = 0; i < ctx->task_count; ++i) {
         sim_task_t* task = &ctx->tasks[i];
         if (!task->ready || task->selected_this_tick) {
             continue;
@@ -199,13 +341,14 @@ static int sim_select_task_htas(sim_context_t* ctx, int cpu_id) {
 
         int score = task->base_priority;
 
-        // HTAS uses *explicit hints*
-        if (task->preferred_type == CPU_TYPE_PCORE) {
+        // HTAS uses *explicit hints*; DEFAULT has no core-type hint
+        bool type_hint = (task->intent != PROFILE_DEFAULT);
+        if (type_hint && task->preferred_type == CPU_TYPE_PCORE) {
             score += (cpu_type == CPU_TYPE_PCORE) ? 12 : -8;
-        } else if (task->preferred_type == CPU_TYPE_ECORE) {
+        } else if (type_hint && task->preferred_type == CPU_TYPE_ECORE) {
             score += (cpu_type == CPU_TYPE_ECORE) ? 12 : -6;
         }
-        if (task->preferred_numa < NUM_NUMA_NODES) {
+        if (task->preferred_numa < ctx->cfg.numa_nodes) {
             score += (cpu_numa == task->preferred_numa) ? 8 : -6;
         }
         if (task->intent == PROFILE_LOW_LATENCY) {
@@ -235,10 +378,10 @@ static int sim_select_task_htas(sim_context_t* ctx, int cpu_id) {
 static int sim_select_task_dynamic(sim_context_t* ctx, int cpu_id) {
     int best_idx = -1;
     int best_score = -1000;
-    cpu_type_t cpu_type = g_cpu_topology[cpu_id].type;
-    uint8_t cpu_numa = g_cpu_topology[cpu_id].numa_node;
+    cpu_type_t cpu_type = ctx->cpu_type[cpu_id];
+    uint8_t cpu_numa = ctx->cpu_numa[cpu_id];
 
-    for (int i = 0; i < SIM_TASK_COUNT; ++i) {
+    for (int i = 0; i < ctx->task_count; ++i) {
         sim_task_t* task = &ctx->tasks[i];
         if (!task->ready || task->selected_this_tick) {
             continue;
@@ -288,13 +431,76 @@ static int sim_select_task_dynamic(sim_context_t* ctx, int cpu_id) {
     return best_idx;
 }
 
+/* --- DEADLINE class (EDF/CBS), consulted before the policy --- */
+static int sim_select_task_deadline(sim_context_t* ctx, int cpu_id) {
+    int best_idx = -1;
+    uint32_t best_deadline = 0;
+    cpu_type_t cpu_type = ctx->cpu_type[cpu_id];
+
+    for (int i = 0; i < ctx->task_count; ++i) {
+        sim_task_t* task = &ctx->tasks[i];
+        // Throttled (no budget left) reservations fall back to the policy
+        if (!task->ready || task->selected_this_tick ||
+            task->dl_runtime_ms == 0 || task->dl_budget == 0) {
+            continue;
+        }
+        // LOW_LATENCY affinity is P-cores only, same as the live class
+        if (cpu_type != CPU_TYPE_PCORE) {
+            continue;
+        }
+
+        uint32_t deadline = task->job_release_tick + task->dl_deadline_ms;
+        if (best_idx < 0 || deadline < best_deadline) {
+            best_idx = i;
+            best_deadline = deadline;
+        }
+    }
+
+    if (best_idx >= 0) {
+        ctx->tasks[best_idx].selected_this_tick = true;
+    }
+    return best_idx;
+}
+
+/* --- SCHEDULER 4: FAIR (Weighted Fair-Share) --- */
+static int sim_select_task_fair(sim_context_t* ctx, int cpu_id) {
+    int best_idx = -1;
+    cpu_type_t cpu_type = ctx->cpu_type[cpu_id];
+
+    for (int i = 0; i < ctx->task_count; ++i) {
+        sim_task_t* task = &ctx->tasks[i];
+        if (!task->ready || task->selected_this_tick) {
+            continue;
+        }
+
+        if (best_idx < 0) {
+            best_idx = i;
+            continue;
+        }
+
+        sim_task_t* best = &ctx->tasks[best_idx];
+        if (task->vruntime < best->vruntime) {
+            best_idx = i;
+        } else if (task->vruntime == best->vruntime &&
+                   task->preferred_type == cpu_type &&
+                   best->preferred_type != cpu_type) {
+            // Equal share owed: break the tie by core-type preference
+            best_idx = i;
+        }
+    }
+
+    if (best_idx >= 0) {
+        ctx->tasks[best_idx].selected_this_tick = true;
+    }
+    return best_idx;
+}
 
 static void sim_update_task_stats(sim_context_t* ctx, scheduler_stats_t* stats, int cpu_id, int task_index) {
-    cpu_type_t cpu_type = g_cpu_topology[cpu_id].type;
-    uint8_t cpu_numa = g_cpu_topology[cpu_id].numa_node;
+    cpu_type_t cpu_type = ctx->cpu_type[cpu_id];
+    uint8_t cpu_numa = ctx->cpu_numa[cpu_id];
 
     if (task_index < 0) {
-        stats->total_power_consumption += (cpu_type == CPU_TYPE_PCORE) ? 30 : 20;
+        stats->total_power_consumption += htas_idle_power_per_ms(cpu_type) * SIM_TICK_US / 1000;
         return;
     }
 
@@ -340,20 +546,23 @@ static void sim_update_task_stats(sim_context_t* ctx, scheduler_stats_t* stats,
 
     task->runtime_us += SIM_TICK_US;
     stats->intent_stats[task->intent].runtime_us += SIM_TICK_US;
+    task->vruntime += ((uint64_t)SIM_TICK_US * FAIR_WEIGHT_NICE0) / htas_fair_weight(task->intent);
 
     // Check NUMA penalty based on *explicit hints*
-    if (task->preferred_numa < NUM_NUMA_NODES && task->preferred_numa != cpu_numa) {
+    if (task->preferred_numa < ctx->cfg.numa_nodes && task->preferred_numa != cpu_numa) {
         stats->numa_penalties++;
         task->numa_penalties++;
     }
 
-    if (task->intent == PROFILE_LOW_LATENCY && task->work_remaining == task->work_ms) {
+    // First tick of a job (or of a replayed run phase): wakeup-to-run latency
+    if ((task->intent == PROFILE_LOW_LATENCY || task->replay) &&
+        task->work_remaining == task->work_ms) {
         uint32_t jitter_us = task->waiting_since_ready * SIM_TICK_US;
-        ctx->latency_total_us += jitter_us;
-        ctx->latency_samples++;
-        if (jitter_us > ctx->latency_max_us) {
-            ctx->latency_max_us = jitter_us;
-        }
+        htas_latency_record(stats, task->intent, jitter_us);
+    }
+
+    if (task->dl_budget > 0) {
+        task->dl_budget--;
     }
 
     if (task->work_remaining > 0) {
@@ -361,6 +570,14 @@ static void sim_update_task_stats(sim_context_t* ctx, scheduler_stats_t* stats,
         if (task->work_remaining == 0) {
             task->time_since_release = 0;
             task->ready = false;
+
+            // Job done at the end of this tick: did it meet its deadline?
+            if (task->dl_deadline_ms > 0) {
+                stats->deadline_jobs++;
+                if (ctx->tick + 1 - task->job_release_tick > task->dl_deadline_ms) {
+                    stats->deadline_misses++;
+                }
+            }
         }
     }
 
@@ -368,10 +585,13 @@ static void sim_update_task_stats(sim_context_t* ctx, scheduler_stats_t* stats,
 }
 
 static void sim_finalize_tick(sim_context_t* ctx) {
-    for (int i = 0; i < SIM_TASK_COUNT; ++i) {
+    uint64_t min_vruntime = 0;
+    bool have_min = false;
+
+    for (int i = 0; i < ctx->task_count; ++i) {
         sim_task_t* task = &ctx->tasks[i];
 
-        if (task->intent == PROFILE_LOW_LATENCY) {
+        if (task->intent == PROFILE_LOW_LATENCY || task->replay) {
             if (task->work_remaining > 0 && !task->scheduled_this_tick) {
                 task->waiting_since_ready++;
             } else if (task->work_remaining == 0) {
@@ -382,8 +602,8 @@ static void sim_finalize_tick(sim_context_t* ctx) {
         // --- Aging Logic ---
         if (task->ready && !task->scheduled_this_tick) {
             task->wait_time++;
-            if (task->wait_time > AGING_THRESHOLD) {
-                task->priority_boost_aging = AGING_PRIORITY_BOOST;
+            if (task->wait_time > ctx->cfg.aging_threshold) {
+                task->priority_boost_aging = ctx->cfg.aging_boost;
             }
         }
 
@@ -395,50 +615,87 @@ static void sim_finalize_tick(sim_context_t* ctx) {
         } 
         // --- End Dynamic Logic ---
 
+        if (task->ready && (!have_min || task->vruntime < min_vruntime)) {
+            min_vruntime = task->vruntime;
+            have_min = true;
+        }
+
         task->selected_this_tick = false;
         task->scheduled_this_tick = false;
     }
+
+    if (have_min && min_vruntime > ctx->fair_min_vruntime) {
+        ctx->fair_min_vruntime = min_vruntime;
+    }
 }
 
-static void simulate_workload(uint32_t duration_ms, scheduler_type_t type, scheduler_stats_t* stats) {
-    sim_context_t ctx;
-    sim_init_tasks(&ctx);
+/* Jain's fairness index over each task's weighted service rate while it was
+ * runnable: (sum x)^2 / (n * sum x^2), scaled to 0..1000. */
+static uint32_t sim_fairness_permille(sim_context_t* ctx) {
+    uint64_t sum = 0, sum_sq = 0;
+    uint32_t n = 0;
+
+    for (int i = 0; i < ctx->task_count; ++i) {
+        sim_task_t* task = &ctx->tasks[i];
+        if (task->ready_ticks == 0) continue;
+        uint64_t x = (task->runtime_us * FAIR_WEIGHT_NICE0)
+                   / htas_fair_weight(task->intent) / task->ready_ticks;
+        sum += x;
+        sum_sq += x * x;
+        n++;
+    }
+
+    if (n == 0 || sum_sq == 0) return 0;
+    return (uint32_t)((sum * sum * 1000u) / (n * sum_sq));
+}
+
+/* Run one scenario. Uses nothing but ctx, cfg and stats. */
+static void simulate_workload(sim_context_t* ctx, const sim_config_t* cfg, scheduler_type_t type,
+                              bool deadline_class, scheduler_stats_t* stats) {
+    sim_init_context(ctx, cfg);
+    if (cfg->replay) {
+        sim_init_replay(ctx);
+    } else {
+        sim_init_tasks(ctx);
+    }
 
     memset(stats, 0, sizeof(scheduler_stats_t));
 
-    for (ctx.tick = 0; ctx.tick < duration_ms; ++ctx.tick) {
+    for (ctx->tick = 0; ctx->tick < cfg->duration_ms; ++ctx->tick) {
         stats->total_ticks++;
 
-        sim_prepare_tick(&ctx);
-
-        int assigned[NUM_CPUS];
-        for (int cpu = 0; cpu < NUM_CPUS; ++cpu) {
-            int task_index;
-            if (type == SCHED_HTAS) {
-                task_index = sim_select_task_htas(&ctx, cpu);
-            } else if (type == SCHED_BASELINE) {
-                task_index = sim_select_task_round_robin(&ctx);
-            } else { // SCHED_DYNAMIC
-                task_index = sim_select_task_dynamic(&ctx, cpu);
+        sim_prepare_tick(ctx);
+
+        int assigned[SIM_MAX_CPUS];
+        for (int cpu = 0; cpu < cfg->num_cpus; ++cpu) {
+            int task_index = -1;
+            // The deadline reservation, if admitted, is served ahead of the policy
+            if (deadline_class) {
+                task_index = sim_select_task_deadline(ctx, cpu);
+            }
+            if (task_index < 0) {
+                if (type == SCHED_HTAS) {
+                    task_index = sim_select_task_htas(ctx, cpu);
+                } else if (type == SCHED_BASELINE) {
+                    task_index = sim_select_task_round_robin(ctx);
+                } else if (type == SCHED_FAIR) {
+                    task_index = sim_select_task_fair(ctx, cpu);
+                } else { // SCHED_DYNAMIC
+                    task_index = sim_select_task_dynamic(ctx, cpu);
+                }
             }
             assigned[cpu] = task_index;
         }
 
-        for (int cpu = 0; cpu < NUM_CPUS; ++cpu) {
+        for (int cpu = 0; cpu < cfg->num_cpus; ++cpu) {
             // Pass the correct stats object to update
-            sim_update_task_stats(&ctx, stats, cpu, assigned[cpu]);
+            sim_update_task_stats(ctx, stats, cpu, assigned[cpu]);
         }
 
-        sim_finalize_tick(&ctx);
+        sim_finalize_tick(ctx);
     }
 
-    if (ctx.latency_samples > 0) {
-        stats->intent_stats[PROFILE_LOW_LATENCY].avg_latency_us =
-            ctx.latency_total_us / ctx.latency_samples;
-    } else {
-        stats->intent_stats[PROFILE_LOW_LATENCY].avg_latency_us = 0;
-    }
-    stats->intent_stats[PROFILE_LOW_LATENCY].max_jitter_us = ctx.latency_max_us;
+    stats->fairness_permille = sim_fairness_permille(ctx);
 }
 
 /* ============================================================================
@@ -493,7 +750,8 @@ void htas_run_aging_benchmark(void) {
 }
 
 
-static void run_benchmark_phase(const char* name, scheduler_type_t sched_type, uint32_t duration_sec, scheduler_stats_t* out_stats) {
+static void run_benchmark_phase(const char* name, scheduler_type_t sched_type, bool deadline_class,
+                                uint32_t duration_sec, scheduler_stats_t* out_stats) {
     printf("\n");
     printf("========================================\n");
     printf(" RUNNING: %s\n", name);
@@ -512,7 +770,9 @@ static void run_benchmark_phase(const char* name, scheduler_type_t sched_type, u
     
     // Run synthetic workload and store results in out_stats
     // Run synthetic workload to populate statistics
-    simulate_workload(duration_sec * 1000u, sched_type, out_stats);
+    sim_config_t cfg;
+    sim_default_config(&cfg, duration_sec * 1000u);
+    simulate_workload(&g_sim_ctx, &cfg, sched_type, deadline_class, out_stats);
 
     for (uint32_t second = 1; second <= duration_sec; ++second) { 
         uint64_t wait_start = pit_ticks();
@@ -544,7 +804,7 @@ void htas_run_full_benchmark(void) {
     printf("\n");
     printf("########################################\n");
     printf("# HTAS FULL BENCHMARK SUITE            #\n");
-    printf("# 3-Way Scheduler Comparison           #\n");
+    printf("# 4-Way Scheduler Comparison           #\n");
     printf("########################################\n\n");
     
     printf("[BENCH] Allocating NUMA buffer (%d KB)...\n", NUMA_BUFFER_SIZE / 1024);
@@ -559,20 +819,30 @@ void htas_run_full_benchmark(void) {
     scheduler_stats_t baseline_results;
     scheduler_stats_t htas_results;
     scheduler_stats_t dynamic_results;
+    scheduler_stats_t fair_results;
+    scheduler_stats_t deadline_results;
     
     uint32_t duration = 15; // 15 seconds per run
     
     // Phase 1: Baseline scheduler
     run_benchmark_phase("BASELINE (Round-Robin)", 
-                        SCHED_BASELINE, duration, &baseline_results);
+                        SCHED_BASELINE, false, duration, &baseline_results);
     
     // Phase 2: HTAS scheduler
     run_benchmark_phase("HTAS (Hint-Based)",
-                        SCHED_HTAS, duration, &htas_results);
+                        SCHED_HTAS, false, duration, &htas_results);
     
     // Phase 3: Dynamic scheduler
     run_benchmark_phase("DYNAMIC (Inference-Based)",
-                        SCHED_DYNAMIC, duration, &dynamic_results);
+                        SCHED_DYNAMIC, false, duration, &dynamic_results);
+
+    // Phase 4: Fair-share scheduler
+    run_benchmark_phase("FAIR (Weighted vruntime)",
+                        SCHED_FAIR, false, duration, &fair_results);
+
+    // Phase 5: HTAS with the LOW_LATENCY deadline reservation admitted
+    run_benchmark_phase("HTAS + DEADLINE (EDF/CBS)",
+                        SCHED_HTAS, true, duration, &deadline_results);
     
     
     // Compare results
@@ -594,6 +864,24 @@ void htas_run_full_benchmark(void) {
     printf("# FINAL RESULTS (HTAS vs DYNAMIC)      #\n");
     printf("########################################\n\n");
     htas_compare_stats(&htas_results, "HTAS", &dynamic_results, "DYNAMIC");
+
+    printf("\n");
+    printf("########################################\n");
+    printf("# FINAL RESULTS (BASELINE vs FAIR)     #\n");
+    printf("########################################\n\n");
+    htas_compare_stats(&baseline_results, "BASELINE", &fair_results, "FAIR");
+
+    printf("\n");
+    printf("########################################\n");
+    printf("# FINAL RESULTS (HTAS vs FAIR)         #\n");
+    printf("########################################\n\n");
+    htas_compare_stats(&htas_results, "HTAS", &fair_results, "FAIR");
+
+    printf("\n");
+    printf("########################################\n");
+    printf("# FINAL RESULTS (HTAS vs HTAS+DL)      #\n");
+    printf("########################################\n\n");
+    htas_compare_stats(&htas_results, "HTAS", &deadline_results, "HTAS+DL");
     
     // Free NUMA buffer
     kfree(g_numa_buffer);
@@ -613,7 +901,7 @@ void htas_run_baseline_benchmark(void) {
     memset(g_numa_buffer, 0, NUMA_BUFFER_SIZE);
     
     scheduler_stats_t stats;
-    run_benchmark_phase("BASELINE SCHEDULER", SCHED_BASELINE, 30, &stats);
+    run_benchmark_phase("BASELINE SCHEDULER", SCHED_BASELINE, false, 30, &stats);
     
     kfree(g_numa_buffer);
     g_numa_buffer = NULL;
@@ -626,12 +914,202 @@ void htas_run_htas_benchmark(void) {
     memset(g_numa_buffer, 0, NUMA_BUFFER_SIZE);
     
     scheduler_stats_t stats;
-    run_benchmark_phase("HTAS SCHEDULER", SCHED_HTAS, 30, &stats);
+    run_benchmark_phase("HTAS SCHEDULER", SCHED_HTAS, false, 30, &stats);
     
     kfree(g_numa_buffer);
     g_numa_buffer = NULL;
 }
 
+/* Replay a recorded (or loaded) workload under each policy. The simulator is
+ * deterministic, so unlike the synthetic phases there is no real-time wait. */
+void htas_run_replay_benchmark(const wl_trace_t* trace) {
+    if (!trace || trace->ntasks == 0) {
+        printf("[REPLAY] No workload: record one with 'wl start'/'wl stop' or 'wl load'\n");
+        return;
+    }
+
+    // Run until the last task has finished its last phase
+    uint32_t duration = trace->duration_ms;
+    for (int i = 0; i < trace->ntasks; ++i) {
+        const wl_task_t* wl = &trace->tasks[i];
+        uint32_t end = wl->arrival_ms;
+        for (int p = 0; p < wl->nphases; ++p) {
+            end += wl->phases[p].run_ms + wl->phases[p].block_ms;
+        }
+        if (end > duration) {
+            duration = end;
+        }
+    }
+
+    printf("\n");
+    printf("########################################\n");
+    printf("# HTAS WORKLOAD REPLAY                 #\n");
+    printf("########################################\n\n");
+    printf("[REPLAY] %u tasks, %u ms simulated\n", trace->ntasks, duration);
+
+    sim_config_t cfg;
+    sim_default_config(&cfg, duration);
+    cfg.replay = trace;
+
+    scheduler_stats_t baseline_results;
+    scheduler_stats_t htas_results;
+    scheduler_stats_t dynamic_results;
+
+    simulate_workload(&g_sim_ctx, &cfg, SCHED_BASELINE, false, &baseline_results);
+    htas_print_stats(&baseline_results, "REPLAY: BASELINE (Round-Robin)");
+
+    simulate_workload(&g_sim_ctx, &cfg, SCHED_HTAS, false, &htas_results);
+    htas_print_stats(&htas_results, "REPLAY: HTAS (Hint-Based)");
+
+    simulate_workload(&g_sim_ctx, &cfg, SCHED_DYNAMIC, false, &dynamic_results);
+    htas_print_stats(&dynamic_results, "REPLAY: DYNAMIC (Inference-Based)");
+
+    printf("\n");
+    printf("########################################\n");
+    printf("# REPLAY RESULTS (BASELINE vs HTAS)    #\n");
+    printf("########################################\n\n");
+    htas_compare_stats(&baseline_results, "BASELINE", &htas_results, "HTAS");
+
+    printf("\n");
+    printf("########################################\n");
+    printf("# REPLAY RESULTS (BASELINE vs DYNAMIC) #\n");
+    printf("########################################\n\n");
+    htas_compare_stats(&baseline_results, "BASELINE", &dynamic_results, "DYNAMIC");
+}
+
+/* ============================================================================
+ * PARAMETER SWEEP
+ * ============================================================================ */
+
+#define SWEEP_CPUS 8
+#define SWEEP_LEN(a) ((int)(sizeof(a) / sizeof((a)[0])))
+
+static const int g_sweep_tasks[] = {8, 16, 32, 64};
+static const int g_sweep_pcores[] = {2, 4, 6};       // Out of SWEEP_CPUS
+static const int g_sweep_numa[] = {1, 2, 4};
+static const uint32_t g_sweep_duty[] = {2, 5, 10};
+static const uint32_t g_sweep_aging[] = {25, 100, 400};
+
+static const scheduler_type_t g_sweep_scheds[] = {
+    SCHED_BASELINE, SCHED_HTAS, SCHED_DYNAMIC, SCHED_FAIR,
+};
+static const char* g_sweep_prefix[] = {"base", "htas", "dyn", "fair"};
+
+static char* csv_put_str(char* p, const char* s) {
+    while (*s) {
+        *p++ = *s++;
+    }
+    return p;
+}
+
+static char* csv_put_u32(char* p, uint32_t v) {
+    char digits[10];
+    int n = 0;
+    do {
+        digits[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    while (n) {
+        *p++ = digits[--n];
+    }
+    return p;
+}
+
+int htas_sweep_points(void) {
+    return SWEEP_LEN(g_sweep_tasks) * SWEEP_LEN(g_sweep_pcores) * SWEEP_LEN(g_sweep_numa)
+         * SWEEP_LEN(g_sweep_duty) * SWEEP_LEN(g_sweep_aging);
+}
+
+void htas_sweep_header(char* row) {
+    static const char* metric[] = {"_power", "_numa_pen", "_switches", "_lowlat_p99_us", "_fair"};
+    char* p = csv_put_str(row, "tasks,cpus,pcores,numa_nodes,effi_duty,aging");
+
+    for (int s = 0; s < SWEEP_LEN(g_sweep_prefix); ++s) {
+        for (int m = 0; m < SWEEP_LEN(metric); ++m) {
+            *p++ = ',';
+            p = csv_put_str(p, g_sweep_prefix[s]);
+            p = csv_put_str(p, metric[m]);
+        }
+    }
+    *csv_put_str(p, "\n") = '\0';
+}
+
+/* Grid point index -> scenario, aging threshold varying fastest */
+static void sweep_config(int index, uint32_t duration_ms, sim_config_t* cfg) {
+    sim_default_config(cfg, duration_ms);
+    cfg->num_cpus = SWEEP_CPUS;
+
+    cfg->aging_threshold = g_sweep_aging[index % SWEEP_LEN(g_sweep_aging)];
+    index /= SWEEP_LEN(g_sweep_aging);
+    cfg->effi_duty_cycle = g_sweep_duty[index % SWEEP_LEN(g_sweep_duty)];
+    index /= SWEEP_LEN(g_sweep_duty);
+    cfg->numa_nodes = g_sweep_numa[index % SWEEP_LEN(g_sweep_numa)];
+    index /= SWEEP_LEN(g_sweep_numa);
+    cfg->num_pcores = g_sweep_pcores[index % SWEEP_LEN(g_sweep_pcores)];
+    index /= SWEEP_LEN(g_sweep_pcores);
+    cfg->task_count = g_sweep_tasks[index % SWEEP_LEN(g_sweep_tasks)];
+}
+
+uint32_t htas_sweep_point(sim_context_t* ctx, int index, uint32_t duration_ms, char* row) {
+    sim_config_t cfg;
+    sweep_config(index, duration_ms, &cfg);
+
+    uint32_t params[] = {
+        (uint32_t)cfg.task_count, (uint32_t)cfg.num_cpus, (uint32_t)cfg.num_pcores,
+        (uint32_t)cfg.numa_nodes, cfg.effi_duty_cycle, cfg.aging_threshold,
+    };
+    char* p = row;
+
+    for (int i = 0; i < SWEEP_LEN(params); ++i) {
+        if (i) *p++ = ',';
+        p = csv_put_u32(p, params[i]);
+    }
+
+    for (int s = 0; s < SWEEP_LEN(g_sweep_scheds); ++s) {
+        scheduler_stats_t stats;
+        simulate_workload(ctx, &cfg, g_sweep_scheds[s], false, &stats);
+
+        uint32_t metrics[] = {
+            (uint32_t)stats.total_power_consumption,
+            (uint32_t)stats.numa_penalties,
+            (uint32_t)stats.context_switches,
+            htas_latency_percentile(&stats, PROFILE_LOW_LATENCY, 990),
+            stats.fairness_permille,
+        };
+        for (int i = 0; i < SWEEP_LEN(metrics); ++i) {
+            *p++ = ',';
+            p = csv_put_u32(p, metrics[i]);
+        }
+    }
+
+    *p++ = '\n';
+    *p = '\0';
+    return duration_ms * SWEEP_LEN(g_sweep_scheds);
+}
+
+void htas_run_sweep(uint32_t duration_ms) {
+    static char row[HTAS_SWEEP_ROW_MAX];
+    int points = htas_sweep_points();
+
+    printf("[SWEEP] %d points x %d schedulers, %u ms each, %d CPUs\n",
+           points, SWEEP_LEN(g_sweep_scheds), duration_ms, SWEEP_CPUS);
+    printf("[SWEEP] CSV goes to serial between the '# htas-sweep' lines\n");
+
+    // Progress dots go to the screen only so the serial CSV stays clean
+    serial_writestring("# htas-sweep begin\n");
+    htas_sweep_header(row);
+    serial_writestring(row);
+
+    for (int i = 0; i < points; ++i) {
+        htas_sweep_point(&g_sim_ctx, i, duration_ms, row);
+        serial_writestring(row);
+        terminal_writestring(".");
+    }
+
+    serial_writestring("# htas-sweep end\n");
+    printf("\n[SWEEP] Done\n");
+}
+
 void htas_print_topology(void) {
     // (This function remains unchanged)
     printf("\n");
@@ -639,13 +1117,12 @@ void htas_print_topology(void) {
     printf("        HTAS HARDWARE TOPOLOGY          \n");
     printf("========================================\n\n");
     
-    printf("Simulated Hardware Configuration:\n");
-    printf("  Total CPUs: %d\n", NUM_CPUS);
-    printf("  NUMA Nodes: %d\n\n", NUM_NUMA_NODES);
+    printf("Hardware Configuration:\n");
+    printf("  Total CPUs: %d\n", g_num_cpus);
+    printf("  NUMA Nodes: %d\n\n", g_num_numa_nodes);
     
     printf("CPU Topology:\n");
-    for (int i = 0; i < NUM_CPUS; i++) {
-        extern cpu_info_t g_cpu_topology[];
+    for (int i = 0; i < g_num_cpus; i++) {
         cpu_info_t* cpu = &g_cpu_topology[i];
         const char* type = (cpu->type == CPU_TYPE_PCORE) ? "P-Core (Fast)" : "E-Core (Efficient)";
         printf("  CPU %d: %-18s NUMA Node %d  %s\n", 
@@ -654,22 +1131,37 @@ void htas_print_topology(void) {
     }
     
     printf("\nNUMA Memory Regions:\n");
-    for (int i = 0; i < NUM_NUMA_NODES; i++) {
-        extern numa_region_t g_numa_regions[];
+    for (int i = 0; i < g_num_numa_regions; i++) {
         numa_region_t* region = &g_numa_regions[i];
         uint32_t size_mb = region->size / (1024 * 1024);
         printf("  Node %d: 0x%08x - 0x%08x (%u MB)\n",
-               i, region->base, region->base + region->size - 1, size_mb);
+               region->node, region->base, region->base + (region->size - 1), size_mb);
+    }
+
+    printf("\nNUMA Distances (SLIT, 10 = local):\n");
+    for (int a = 0; a < g_num_numa_nodes; a++) {
+        printf("  Node %d:", a);
+        for (int b = 0; b < g_num_numa_nodes; b++) {
+            printf(" %d", htas_numa_distance((uint8_t)a, (uint8_t)b));
+        }
+        printf("\n");
     }
     
     printf("\nSimulation Parameters:\n");
     printf("  E-Core Slowdown: 2x (50%% performance)\n");
-    printf("  NUMA Penalty: 100 cycles (cross-node access)\n");
+    printf("  NUMA Penalty: %d cycles per 10 units of distance\n", NUMA_PENALTY_CYCLES);
     printf("  LOW_LATENCY Priority Boost: +10\n");
     printf("  AGING Threshold: %d ticks\n", AGING_THRESHOLD);
     printf("  AGING Priority Boost: +%d\n", AGING_PRIORITY_BOOST);
     printf("  DYNAMIC Load Window: %d ticks\n", DYNAMIC_INFERENCE_WINDOW);
     printf("  DYNAMIC Load Threshold: %d ticks\n", DYNAMIC_LOAD_THRESHOLD);
+    printf("  FAIR Weights: PERF=%d EFFI=%d LOW_LAT=%d DEFAULT=%d\n",
+           FAIR_WEIGHT_PERFORMANCE, FAIR_WEIGHT_EFFICIENCY,
+           FAIR_WEIGHT_LOW_LATENCY, FAIR_WEIGHT_NICE0);
+    printf("  DEADLINE Reservation (LOW_LAT): %d ms every 16 ms, deadline %d ms\n",
+           SIM_DL_RUNTIME_MS, SIM_DL_DEADLINE_MS);
+    printf("  DEADLINE Admission Limit: %d per mille of P-core capacity\n",
+           DL_MAX_UTIL_PERMILLE);
 
     printf("\nTask Intent Profiles:\n");
     printf("  PROFILE_PERFORMANCE  -> Prefers P-cores, maximizes throughput\n");
@@ -679,9 +1171,7 @@ void htas_print_topology(void) {
     
     extern scheduler_type_t htas_get_scheduler(void);
     scheduler_type_t current = htas_get_scheduler();
-    printf("\nCurrent Scheduler: %s\n", 
-           (current == SCHED_BASELINE) ? "BASELINE" : 
-           (current == SCHED_HTAS) ? "HTAS" : "DYNAMIC");
+    printf("\nCurrent Scheduler: %s\n", htas_scheduler_name(current));
     
     printf("\n========================================\n\n");
 }
\ No newline at end of file
@@ -0,0 +1,218 @@
+/* HTAS DEADLINE class - EDF with Constant Bandwidth Server
+ *
+ * LOW_LATENCY tasks may reserve dl_runtime_us of CPU time every dl_period_us.
+ * Admission control keeps the sum of runtime/period under
+ * DL_MAX_UTIL_PERMILLE of the P-core capacity, so every admitted set is
+ * schedulable. Runnable reservations are ordered by absolute deadline and the
+ * earliest one runs ahead of whatever policy is active.
+ *
+ * CBS rules: a task that overruns its budget is throttled until the next
+ * period (so it cannot steal bandwidth from others), and a task that wakes
+ * with more budget than it could use before its old deadline gets a fresh
+ * deadline and budget.
+ */
+
+#include <kernel/htas.h>
+#include <kernel/process.h>
+#include <kernel/rbtree.h>
+#include <kernel/stdio.h>
+
+static struct rb_root g_dl_tasks = RB_ROOT_INIT;
+static uint32_t g_dl_util_permille = 0;   // Sum of admitted runtime/period
+
+static inline bool is_dl_task(process_t* proc) {
+    return proc && proc->se.dl_admitted && proc->htas_info;
+}
+
+static uint32_t util_permille(const task_profile_t* profile) {
+    return (uint32_t)(((uint64_t)profile->dl_runtime_us * 1000u + profile->dl_period_us - 1)
+                      / profile->dl_period_us);
+}
+
+static uint32_t pcore_capacity_permille(void) {
+    uint32_t pcores = 0;
+    for (int i = 0; i < g_num_cpus; i++) {
+        if (g_cpu_topology[i].online && g_cpu_topology[i].type == CPU_TYPE_PCORE) {
+            pcores++;
+        }
+    }
+    return pcores * DL_MAX_UTIL_PERMILLE;
+}
+
+static void rq_insert(htas_entity_t* se) {
+    struct rb_node** link = &g_dl_tasks.node;
+    struct rb_node* parent = NULL;
+
+    while (*link) {
+        parent = *link;
+        htas_entity_t* entry = rb_entry(parent, htas_entity_t, dl_node);
+        link = (se->dl_abs_deadline_us < entry->dl_abs_deadline_us)
+             ? &parent->left : &parent->right;
+    }
+
+    rb_link_node(&se->dl_node, parent, link);
+    rb_insert_color(&se->dl_node, &g_dl_tasks);
+    se->dl_on_rq = true;
+}
+
+static void rq_remove(htas_entity_t* se) {
+    if (!se->dl_on_rq) return;
+    rb_erase(&se->dl_node, &g_dl_tasks);
+    se->dl_on_rq = false;
+}
+
+static void record_job_end(htas_entity_t* se, uint64_t now) {
+    scheduler_stats_t* stats = htas_get_stats();
+    stats->deadline_jobs++;
+    if (now > se->dl_abs_deadline_us) {
+        se->dl_misses++;
+        stats->deadline_misses++;
+    }
+}
+
+int htas_dl_admit(process_t* proc, const task_profile_t* profile) {
+    htas_entity_t* se = &proc->se;
+
+    if (profile->dl_runtime_us == 0) {
+        htas_dl_release(proc);
+        return 0;
+    }
+
+    if (profile->intent != PROFILE_LOW_LATENCY) {
+        printf("[HTAS] PID %d: deadline parameters require LOW_LATENCY intent\n", proc->pid);
+        return -1;
+    }
+
+    uint32_t deadline = profile->dl_deadline_us ? profile->dl_deadline_us : profile->dl_period_us;
+    if (profile->dl_period_us == 0 || profile->dl_runtime_us > deadline ||
+        deadline > profile->dl_period_us) {
+        printf("[HTAS] PID %d: invalid deadline parameters (need runtime <= deadline <= period)\n",
+               proc->pid);
+        return -1;
+    }
+
+    // Give back any previous reservation before checking the new one
+    uint32_t current = g_dl_util_permille;
+    if (is_dl_task(proc)) {
+        current -= util_permille(&proc->htas_info->profile);
+    }
+
+    uint32_t util = util_permille(profile);
+    if (current + util > pcore_capacity_permille()) {
+        printf("[HTAS] PID %d: deadline admission rejected (util %u + %u > %u per mille)\n",
+               proc->pid, current, util, pcore_capacity_permille());
+        return -1;
+    }
+
+    htas_dl_release(proc);
+    g_dl_util_permille = current + util;
+
+    uint64_t now = htas_now_us();
+    se->dl_admitted = true;
+    se->dl_throttled = false;
+    se->dl_budget_us = profile->dl_runtime_us;
+    se->dl_abs_deadline_us = now + deadline;
+    se->dl_replenish_us = now + profile->dl_period_us;
+    return 0;
+}
+
+void htas_dl_release(process_t* proc) {
+    if (!is_dl_task(proc)) return;
+    htas_entity_t* se = &proc->se;
+
+    rq_remove(se);
+    g_dl_util_permille -= util_permille(&proc->htas_info->profile);
+    se->dl_admitted = false;
+    se->dl_throttled = false;
+}
+
+void htas_dl_enqueue(process_t* proc) {
+    if (!is_dl_task(proc)) return;
+    htas_entity_t* se = &proc->se;
+    const task_profile_t* p = &proc->htas_info->profile;
+
+    if (se->dl_on_rq || se->dl_throttled) return;
+
+    // CBS wakeup rule: keep the old (deadline, budget) pair only if the
+    // remaining budget fits in the remaining time at the reserved rate.
+    uint64_t now = htas_now_us();
+    uint32_t deadline = p->dl_deadline_us ? p->dl_deadline_us : p->dl_period_us;
+    bool expired = se->dl_abs_deadline_us <= now;
+    if (expired ||
+        (uint64_t)se->dl_budget_us * p->dl_period_us >
+        (se->dl_abs_deadline_us - now) * p->dl_runtime_us) {
+        se->dl_abs_deadline_us = now + deadline;
+        se->dl_replenish_us = now + p->dl_period_us;
+        se->dl_budget_us = p->dl_runtime_us;
+    }
+
+    rq_insert(se);
+}
+
+void htas_dl_dequeue(process_t* proc) {
+    if (!is_dl_task(proc)) return;
+    htas_entity_t* se = &proc->se;
+
+    // Blocking ends the current job
+    if (se->dl_on_rq) {
+        record_job_end(se, htas_now_us());
+    }
+    rq_remove(se);
+}
+
+void htas_dl_charge(process_t* proc, uint32_t delta_us) {
+    if (!is_dl_task(proc)) return;
+    htas_entity_t* se = &proc->se;
+    if (!se->dl_on_rq) return;
+
+    se->dl_budget_us -= delta_us;
+    if (se->dl_budget_us > 0) return;
+
+    // Overrun: the job used its whole reservation. Throttle until the next
+    // period so the remaining work competes in the normal policy instead.
+    uint64_t now = htas_now_us();
+    record_job_end(se, now);
+    rq_remove(se);
+    se->dl_throttled = true;
+    if (se->dl_replenish_us <= now) {
+        se->dl_replenish_us = now + proc->htas_info->profile.dl_period_us;
+    }
+}
+
+void htas_dl_replenish(void) {
+    uint64_t now = htas_now_us();
+    process_t* processes = process_get_list();
+
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        process_t* proc = &processes[i];
+        if (proc->state == PROC_UNUSED || !is_dl_task(proc)) continue;
+
+        htas_entity_t* se = &proc->se;
+        if (!se->dl_throttled || now < se->dl_replenish_us) continue;
+
+        const task_profile_t* p = &proc->htas_info->profile;
+        uint32_t deadline = p->dl_deadline_us ? p->dl_deadline_us : p->dl_period_us;
+        se->dl_throttled = false;
+        se->dl_budget_us = p->dl_runtime_us;
+        se->dl_abs_deadline_us = se->dl_replenish_us + deadline;
+        se->dl_replenish_us += p->dl_period_us;
+
+        if (proc->state == PROC_READY || proc->state == PROC_RUNNING) {
+            rq_insert(se);
+        }
+    }
+}
+
+struct process* htas_dl_select_next(uint8_t cpu_id) {
+    for (struct rb_node* node = rb_first(&g_dl_tasks); node; node = rb_next(node)) {
+        process_t* proc = rb_entry(node, process_t, se.dl_node);
+        if (htas_can_run_on_cpu(proc, cpu_id)) {
+            return proc;
+        }
+    }
+    return NULL;
+}
+
+uint32_t htas_dl_total_util_permille(void) {
+    return g_dl_util_permille;
+}
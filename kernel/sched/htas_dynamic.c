@@ -0,0 +1,230 @@
+/* HTAS DYNAMIC class - intent inference from runtime behaviour
+ *
+ * Unhinted processes get an intent inferred from what they actually do over
+ * the last DYN_WINDOW_TICKS scheduler ticks:
+ *   - CPU demand: ticks spent runnable (running or waiting for a CPU)
+ *   - CPU burst: CPU ticks between voluntary blocks (EWMA)
+ *   - switch mix: voluntary (blocked/exited) vs involuntary (preempted)
+ *   - I/O waits: ticks spent inside a blocking read or wait()
+ *   - NUMA: node that most simulated memory accesses hit, falling back to
+ *     the node the page directory was allocated from
+ *
+ * Mostly-runnable tasks become PERFORMANCE, mostly-idle ones EFFICIENCY, and
+ * tasks that block on I/O with short bursts become LOW_LATENCY. Explicit
+ * hints always win over the inference.
+ */
+
+#include <kernel/htas.h>
+#include <kernel/process.h>
+#include <kernel/stdio.h>
+
+static uint32_t bit_count(uint32_t v) {
+    uint32_t n = 0;
+    while (v) {
+        v &= v - 1;
+        n++;
+    }
+    return n;
+}
+
+static uint32_t voluntary_permille(const htas_entity_t* se) {
+    uint32_t total = se->nvcsw + se->nivcsw;
+    return total ? (se->nvcsw * 1000u) / total : 0;
+}
+
+static void end_burst(htas_entity_t* se) {
+    if (se->burst_ticks == 0) return;
+    // EWMA with alpha = 1/8, kept in ticks * 8
+    se->avg_burst_x8 = se->avg_burst_x8 - (se->avg_burst_x8 >> 3) + se->burst_ticks;
+    se->burst_ticks = 0;
+}
+
+static task_intent_t classify(const htas_entity_t* se) {
+    if (se->observed_ticks < DYN_WINDOW_TICKS) {
+        return PROFILE_DEFAULT;  // Not enough history yet
+    }
+
+    uint32_t demand = bit_count(se->demand_history);
+    uint32_t io = bit_count(se->io_history);
+
+    if (io >= DYN_LOWLAT_MIN_IO_TICKS &&
+        se->avg_burst_x8 <= DYN_LOWLAT_MAX_BURST * 8 &&
+        voluntary_permille(se) >= DYN_LOWLAT_MIN_VOL) {
+        return PROFILE_LOW_LATENCY;
+    }
+
+    // Hysteresis so a CPU hog does not flap on a short pause
+    uint32_t perf_min = (se->inferred_intent == PROFILE_PERFORMANCE)
+                      ? DYN_PERF_LEAVE_TICKS : DYN_PERF_ENTER_TICKS;
+    if (demand >= perf_min) {
+        return PROFILE_PERFORMANCE;
+    }
+
+    if (demand <= DYN_EFFI_MAX_TICKS && io == 0) {
+        return PROFILE_EFFICIENCY;
+    }
+
+    return PROFILE_DEFAULT;
+}
+
+void htas_dyn_tick(struct process* current) {
+    process_t* processes = process_get_list();
+
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        process_t* proc = &processes[i];
+        if (proc->state == PROC_UNUSED || proc->state == PROC_ZOMBIE) continue;
+
+        htas_entity_t* se = &proc->se;
+        bool runnable = (proc->state == PROC_READY || proc->state == PROC_RUNNING)
+                        && !se->io_waiting;
+
+        se->run_history <<= 1;
+        se->demand_history <<= 1;
+        se->io_history <<= 1;
+
+        if (se->io_waiting) {
+            se->io_history |= 1;
+        } else if (proc == current && runnable) {
+            se->run_history |= 1;
+            se->demand_history |= 1;
+            se->burst_ticks++;
+            se->wait_ticks = 0;
+        } else if (runnable) {
+            se->demand_history |= 1;
+            se->wait_ticks++;
+        }
+
+        if (se->observed_ticks < DYN_WINDOW_TICKS) {
+            se->observed_ticks++;
+        }
+        se->inferred_intent = classify(se);
+    }
+}
+
+void htas_dyn_switch(struct process* prev) {
+    if (!prev) return;
+    htas_entity_t* se = &prev->se;
+
+    bool runnable = (prev->state == PROC_READY || prev->state == PROC_RUNNING);
+    if (runnable && !se->io_waiting) {
+        se->nivcsw++;
+    } else {
+        se->nvcsw++;
+        end_burst(se);
+    }
+}
+
+void htas_io_wait_begin(struct process* proc) {
+    if (!proc || proc->se.io_waiting) return;
+    htas_acct_io_begin(proc);
+    htas_wl_block_begin(proc);
+    proc->se.io_waiting = true;
+    end_burst(&proc->se);
+}
+
+void htas_io_wait_end(struct process* proc) {
+    if (!proc || !proc->se.io_waiting) return;
+    proc->se.io_waiting = false;
+    htas_acct_io_end(proc);
+    htas_wl_block_end(proc);
+}
+
+void htas_dyn_memory_access(struct process* proc, uint8_t numa_node) {
+    if (!proc || numa_node >= HTAS_MAX_NUMA_NODES) return;
+    htas_entity_t* se = &proc->se;
+
+    // Halve all counters when one saturates so old phases fade out
+    if (++se->numa_hits[numa_node] >= 1024) {
+        for (int n = 0; n < HTAS_MAX_NUMA_NODES; n++) {
+            se->numa_hits[n] >>= 1;
+        }
+    }
+}
+
+uint8_t htas_dyn_numa_node(struct process* proc) {
+    const htas_entity_t* se = &proc->se;
+    uint8_t best = 0;
+    uint32_t best_hits = 0;
+
+    for (int n = 0; n < HTAS_MAX_NUMA_NODES; n++) {
+        if (se->numa_hits[n] > best_hits) {
+            best_hits = se->numa_hits[n];
+            best = (uint8_t)n;
+        }
+    }
+    if (best_hits > 0) {
+        return best;
+    }
+
+    // No samples yet: the address space lives where its page directory was allocated
+    return htas_get_numa_node_for_address((void*)(uintptr_t)proc->page_dir);
+}
+
+struct process* htas_dyn_select_next(uint8_t cpu_id) {
+    process_t* best = NULL;
+    int best_score = -1000;
+    cpu_type_t cpu_type = htas_get_cpu_type(cpu_id);
+    uint8_t cpu_numa = htas_get_numa_node_for_cpu(cpu_id);
+
+    process_t* processes = process_get_list();
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        process_t* proc = &processes[i];
+
+        if (proc->state != PROC_READY && proc->state != PROC_RUNNING) continue;
+        if (!htas_can_run_on_cpu(proc, cpu_id)) continue;
+
+        int score = 0;
+
+        // Same weights as sim_select_task_dynamic()
+        switch (htas_task_intent(proc)) {
+            case PROFILE_PERFORMANCE:
+                score += (cpu_type == CPU_TYPE_PCORE) ? 12 : -8;
+                break;
+            case PROFILE_LOW_LATENCY:
+                score += (cpu_type == CPU_TYPE_PCORE) ? 12 : -8;
+                score += 15;
+                if (proc->se.io_history & 0x3) {
+                    score += 5;  // Just woke from I/O
+                }
+                break;
+            case PROFILE_EFFICIENCY:
+                score += (cpu_type == CPU_TYPE_ECORE) ? 12 : -6;
+                break;
+            case PROFILE_DEFAULT:
+                break;
+        }
+
+        score += htas_numa_score(htas_dyn_numa_node(proc), cpu_numa, 8, -6);
+        score += (int)(proc->se.wait_ticks / 4);
+
+        if (score > best_score || !best) {
+            best_score = score;
+            best = proc;
+        }
+    }
+
+    return best;
+}
+
+void htas_print_inference(void) {
+    const char* intent_name[] = {"PERFORMANCE", "EFFICIENCY", "LOW_LATENCY", "DEFAULT"};
+    process_t* processes = process_get_list();
+
+    printf("\n========================================\n");
+    printf(" DYNAMIC INFERENCE (last %d ticks)\n", DYN_WINDOW_TICKS);
+    printf("========================================\n");
+
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        process_t* proc = &processes[i];
+        if (proc->state == PROC_UNUSED) continue;
+        htas_entity_t* se = &proc->se;
+
+        printf("PID %d: %s%s\n", proc->pid, intent_name[se->inferred_intent],
+               proc->htas_info ? " (hint overrides)" : "");
+        printf("  run %u / demand %u / io %u ticks, burst %u/8 ticks\n",
+               bit_count(se->run_history), bit_count(se->demand_history),
+               bit_count(se->io_history), se->avg_burst_x8);
+        printf("  switches: %u voluntary, %u involuntary (%u per mille voluntary), NUMA node %d\n",
+               se->nvcsw, se->nivcsw, voluntary_permille(se), htas_dyn_numa_node(proc));
+    }
+}
@@ -0,0 +1,124 @@
+/* HTAS FAIR class - weighted fair-share scheduling
+ *
+ * Every runnable process sits in a red-black tree keyed on vruntime. Running
+ * for delta us advances vruntime by delta * 1024 / weight, where the weight
+ * comes from the task intent, so under contention each task receives CPU time
+ * in proportion to its weight. The next task is the leftmost one whose
+ * affinity mask allows the CPU being scheduled.
+ */
+
+#include <kernel/htas.h>
+#include <kernel/process.h>
+#include <kernel/rbtree.h>
+
+typedef struct {
+    struct rb_root tasks;
+    struct rb_node* leftmost;   // Cached smallest vruntime
+    uint32_t nr_running;
+    uint64_t min_vruntime;      // Monotonic floor used to place new/waking tasks
+} fair_rq_t;
+
+static fair_rq_t g_fair_rq = { .tasks = RB_ROOT_INIT };
+
+uint32_t htas_fair_weight(task_intent_t intent) {
+    switch (intent) {
+        case PROFILE_PERFORMANCE: return FAIR_WEIGHT_PERFORMANCE;
+        case PROFILE_EFFICIENCY:  return FAIR_WEIGHT_EFFICIENCY;
+        case PROFILE_LOW_LATENCY: return FAIR_WEIGHT_LOW_LATENCY;
+        case PROFILE_DEFAULT:
+        default:                  return FAIR_WEIGHT_NICE0;
+    }
+}
+
+static void rq_insert(fair_rq_t* rq, process_t* proc) {
+    struct rb_node** link = &rq->tasks.node;
+    struct rb_node* parent = NULL;
+    bool leftmost = true;
+
+    while (*link) {
+        parent = *link;
+        process_t* entry = rb_entry(parent, process_t, se.run_node);
+        if (proc->se.vruntime < entry->se.vruntime) {
+            link = &parent->left;
+        } else {
+            link = &parent->right;
+            leftmost = false;
+        }
+    }
+
+    rb_link_node(&proc->se.run_node, parent, link);
+    rb_insert_color(&proc->se.run_node, &rq->tasks);
+    if (leftmost) {
+        rq->leftmost = &proc->se.run_node;
+    }
+}
+
+static void rq_remove(fair_rq_t* rq, process_t* proc) {
+    if (rq->leftmost == &proc->se.run_node) {
+        rq->leftmost = rb_next(&proc->se.run_node);
+    }
+    rb_erase(&proc->se.run_node, &rq->tasks);
+}
+
+static void update_min_vruntime(fair_rq_t* rq) {
+    if (!rq->leftmost) return;
+    process_t* first = rb_entry(rq->leftmost, process_t, se.run_node);
+    if (first->se.vruntime > rq->min_vruntime) {
+        rq->min_vruntime = first->se.vruntime;
+    }
+}
+
+void htas_fair_enqueue(process_t* proc) {
+    fair_rq_t* rq = &g_fair_rq;
+    if (proc->se.on_rq) return;
+
+    // New tasks start at the floor; waking tasks keep a bounded credit so
+    // a long sleep cannot be banked into a burst that starves everyone else.
+    uint64_t floor = rq->min_vruntime;
+    if (proc->se.vruntime != 0 && floor > FAIR_WAKEUP_CREDIT_US) {
+        floor -= FAIR_WAKEUP_CREDIT_US;
+    }
+    if (proc->se.vruntime < floor) {
+        proc->se.vruntime = floor;
+    }
+
+    rq_insert(rq, proc);
+    proc->se.on_rq = true;
+    rq->nr_running++;
+}
+
+void htas_fair_dequeue(process_t* proc) {
+    fair_rq_t* rq = &g_fair_rq;
+    if (!proc->se.on_rq) return;
+
+    rq_remove(rq, proc);
+    proc->se.on_rq = false;
+    rq->nr_running--;
+    update_min_vruntime(rq);
+}
+
+void htas_fair_charge(process_t* proc, uint32_t delta_us) {
+    fair_rq_t* rq = &g_fair_rq;
+    if (!proc || !proc->se.on_rq || delta_us == 0) return;
+
+    uint32_t weight = htas_fair_weight(htas_task_intent(proc));
+
+    // Re-key: the node must leave the tree while its vruntime changes.
+    rq_remove(rq, proc);
+    proc->se.vruntime += ((uint64_t)delta_us * FAIR_WEIGHT_NICE0) / weight;
+    rq_insert(rq, proc);
+    update_min_vruntime(rq);
+}
+
+struct process* htas_fair_select_next(uint8_t cpu_id) {
+    fair_rq_t* rq = &g_fair_rq;
+
+    for (struct rb_node* node = rq->leftmost; node; node = rb_next(node)) {
+        process_t* proc = rb_entry(node, process_t, se.run_node);
+        if (htas_can_run_on_cpu(proc, cpu_id)) {
+            return proc;
+        }
+    }
+
+    return NULL;
+}
@@ -0,0 +1,233 @@
+/* HTAS NUMA layout
+ *
+ * Built once at boot, after the CPU topology. The ACPI SRAT gives the
+ * memory ranges of each proximity domain and the domain of each CPU; the
+ * SLIT gives the distance between domains. Domains are renumbered to dense
+ * node ids in ascending order, so QEMU's -numa node,nodeid=N stays node N
+ * when the ids are contiguous. Without an SRAT the layout is
+ * simulated: one 128MB range per node of the CPU topology.
+ */
+
+#include <kernel/htas.h>
+#include <kernel/acpi.h>
+#include <kernel/stdio.h>
+#include <string.h>
+
+#define SIM_NODE_SIZE 0x08000000u      /* 128MB per simulated node */
+
+numa_region_t g_numa_regions[HTAS_MAX_NUMA_REGIONS];
+int g_num_numa_regions = 0;
+int g_num_numa_nodes = 1;
+
+static uint32_t s_node_domain[HTAS_MAX_NUMA_NODES];   // ACPI proximity domain
+static int s_domain_count = 0;
+static uint8_t s_distance[HTAS_MAX_NUMA_NODES][HTAS_MAX_NUMA_NODES];
+static const char* s_source = "simulated";
+
+/* Register a proximity domain, keeping s_node_domain sorted */
+static void add_domain(uint32_t domain) {
+    int i = s_domain_count;
+    while (i > 0 && s_node_domain[i - 1] > domain) {
+        i--;
+    }
+    if (i > 0 && s_node_domain[i - 1] == domain) return;
+    if (s_domain_count >= HTAS_MAX_NUMA_NODES) return;
+
+    memmove(&s_node_domain[i + 1], &s_node_domain[i], (s_domain_count - i) * sizeof(uint32_t));
+    s_node_domain[i] = domain;
+    s_domain_count++;
+}
+
+/* Dense node id for a proximity domain, -1 when it did not fit */
+static int node_for_domain(uint32_t domain) {
+    for (int n = 0; n < s_domain_count; n++) {
+        if (s_node_domain[n] == domain) return n;
+    }
+    return -1;
+}
+
+/* Insert keeping the table sorted by base; overlapping ranges are dropped */
+static void add_region(uint64_t base, uint64_t length, uint8_t node) {
+    if (length == 0 || base >= 0x100000000ull) return;   // Not addressable
+    if (base + length > 0x100000000ull) length = 0x100000000ull - base;
+    if (length > 0xFFFFFFFFull) length = 0xFFFFFFFFull;
+    if (g_num_numa_regions >= HTAS_MAX_NUMA_REGIONS) return;
+
+    uint32_t b = (uint32_t)base;
+    uint32_t size = (uint32_t)length;
+    int i = g_num_numa_regions;
+    while (i > 0 && g_numa_regions[i - 1].base > b) {
+        i--;
+    }
+    if (i > 0 && b - g_numa_regions[i - 1].base < g_numa_regions[i - 1].size) return;
+    if (i < g_num_numa_regions && g_numa_regions[i].base - b < size) return;
+
+    memmove(&g_numa_regions[i + 1], &g_numa_regions[i],
+            (g_num_numa_regions - i) * sizeof(numa_region_t));
+    g_numa_regions[i] = (numa_region_t){ .base = b, .size = size, .node = node };
+    g_num_numa_regions++;
+}
+
+static void set_cpu_node(uint32_t apic_id, int node) {
+    for (int i = 0; i < g_num_cpus; i++) {
+        if (g_cpu_topology[i].apic_id == apic_id) {
+            g_cpu_topology[i].numa_node = (uint8_t)node;
+        }
+    }
+}
+
+static uint32_t cpu_affinity_domain(const srat_cpu_affinity_t* cpu) {
+    return cpu->domain_lo | ((uint32_t)cpu->domain_hi[0] << 8) |
+           ((uint32_t)cpu->domain_hi[1] << 16) | ((uint32_t)cpu->domain_hi[2] << 24);
+}
+
+/* Two passes: the first only collects domains (apply = false) so node ids
+   are known before the second records memory ranges and CPU nodes */
+static void walk_srat(const acpi_srat_t* srat, bool apply) {
+    // htas.topo= already placed the CPUs; only take the memory layout
+    bool place_cpus = apply && !htas_topology_is_override();
+    const uint8_t* p = (const uint8_t*)srat + sizeof(acpi_srat_t);
+    const uint8_t* end = (const uint8_t*)srat + srat->header.length;
+
+    while (p + sizeof(acpi_subtable_t) <= end) {
+        const acpi_subtable_t* sub = (const acpi_subtable_t*)p;
+        if (sub->length < sizeof(acpi_subtable_t) || p + sub->length > end) break;
+
+        if (sub->type == SRAT_MEMORY_AFFINITY && sub->length >= sizeof(srat_memory_affinity_t)) {
+            const srat_memory_affinity_t* mem = (const srat_memory_affinity_t*)sub;
+            int node = node_for_domain(mem->domain);
+            if (!apply) {
+                add_domain(mem->domain);
+            } else if ((mem->flags & SRAT_ENABLED) && node >= 0) {
+                add_region(mem->base, mem->length, (uint8_t)node);
+            }
+        } else if (sub->type == SRAT_CPU_AFFINITY && sub->length >= sizeof(srat_cpu_affinity_t)) {
+            const srat_cpu_affinity_t* cpu = (const srat_cpu_affinity_t*)sub;
+            int node = node_for_domain(cpu_affinity_domain(cpu));
+            if (!apply) {
+                add_domain(cpu_affinity_domain(cpu));
+            } else if (place_cpus && (cpu->flags & SRAT_ENABLED) && node >= 0) {
+                set_cpu_node(cpu->apic_id, node);
+            }
+        } else if (sub->type == SRAT_X2APIC_AFFINITY && sub->length >= sizeof(srat_x2apic_affinity_t)) {
+            const srat_x2apic_affinity_t* x2 = (const srat_x2apic_affinity_t*)sub;
+            int node = node_for_domain(x2->domain);
+            if (!apply) {
+                add_domain(x2->domain);
+            } else if (place_cpus && (x2->flags & SRAT_ENABLED) && node >= 0) {
+                set_cpu_node(x2->x2apic_id, node);
+            }
+        }
+        p += sub->length;
+    }
+}
+
+static void parse_srat(void) {
+    const acpi_srat_t* srat = (const acpi_srat_t*)acpi_find_table("SRAT");
+    if (!srat) return;
+
+    walk_srat(srat, false);
+    walk_srat(srat, true);
+    if (g_num_numa_regions > 0) {
+        s_source = "ACPI SRAT";
+    }
+}
+
+static void parse_slit(void) {
+    const acpi_slit_t* slit = (const acpi_slit_t*)acpi_find_table("SLIT");
+    if (!slit || slit->localities > 0xFF) return;
+
+    uint32_t n = (uint32_t)slit->localities;
+    if (slit->header.length < sizeof(acpi_slit_t) + n * n) return;
+
+    for (int a = 0; a < s_domain_count; a++) {
+        for (int b = 0; b < s_domain_count; b++) {
+            uint32_t da = s_node_domain[a], db = s_node_domain[b];
+            if (da >= n || db >= n) continue;
+            uint8_t d = slit->distance[da * n + db];
+            if (d >= NUMA_LOCAL_DISTANCE) {
+                s_distance[a][b] = d;
+            }
+        }
+    }
+}
+
+void htas_numa_init(void) {
+    for (int a = 0; a < HTAS_MAX_NUMA_NODES; a++) {
+        for (int b = 0; b < HTAS_MAX_NUMA_NODES; b++) {
+            s_distance[a][b] = (a == b) ? NUMA_LOCAL_DISTANCE : NUMA_REMOTE_DISTANCE;
+        }
+    }
+
+    parse_srat();
+    if (s_domain_count > 0) {
+        parse_slit();
+    }
+
+    int nodes = (s_domain_count > 0) ? s_domain_count : 1;
+    for (int i = 0; i < g_num_cpus; i++) {
+        if (g_cpu_topology[i].numa_node >= nodes) {
+            nodes = g_cpu_topology[i].numa_node + 1;
+        }
+    }
+    g_num_numa_nodes = nodes;
+
+    if (g_num_numa_regions == 0) {
+        for (int n = 0; n < nodes; n++) {
+            add_region((uint64_t)n * SIM_NODE_SIZE, SIM_NODE_SIZE, (uint8_t)n);
+        }
+    }
+}
+
+void htas_numa_print(void) {
+    printf("[HTAS] NUMA Regions (%s, %d nodes):\n", s_source, g_num_numa_nodes);
+    for (int i = 0; i < g_num_numa_regions; i++) {
+        printf("[HTAS]   Node %d: 0x%08x - 0x%08x\n", g_numa_regions[i].node,
+               g_numa_regions[i].base,
+               g_numa_regions[i].base + (g_numa_regions[i].size - 1));
+    }
+
+    printf("[HTAS] NUMA Distances:\n");
+    for (int a = 0; a < g_num_numa_nodes; a++) {
+        printf("[HTAS]  ");
+        for (int b = 0; b < g_num_numa_nodes; b++) {
+            printf(" %d", s_distance[a][b]);
+        }
+        printf("\n");
+    }
+}
+
+uint8_t htas_numa_distance(uint8_t from, uint8_t to) {
+    if (from >= HTAS_MAX_NUMA_NODES || to >= HTAS_MAX_NUMA_NODES) {
+        return NUMA_REMOTE_DISTANCE;
+    }
+    return s_distance[from][to];
+}
+
+int htas_numa_score(uint8_t mem_node, uint8_t cpu_node, int local, int remote) {
+    int d = htas_numa_distance(mem_node, cpu_node);
+    if (d <= NUMA_LOCAL_DISTANCE) return local;
+    return local + (remote - local) * (d - NUMA_LOCAL_DISTANCE) /
+                   (NUMA_REMOTE_DISTANCE - NUMA_LOCAL_DISTANCE);
+}
+
+/* Binary search for the last region starting at or below the address */
+uint8_t htas_get_numa_node_for_address(void* addr) {
+    uint32_t address = (uint32_t)(uintptr_t)addr;
+    int lo = 0, hi = g_num_numa_regions - 1, found = -1;
+
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if (g_numa_regions[mid].base <= address) {
+            found = mid;
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+
+    if (found >= 0 && address - g_numa_regions[found].base < g_numa_regions[found].size) {
+        return g_numa_regions[found].node;
+    }
+    return 0;
+}
@@ -0,0 +1,187 @@
+/* HTAS time slices
+ *
+ * Under HTAS every tick used to be a rescheduling point. Each intent now
+ * has a slice in ticks: the running task keeps the CPU until its slice
+ * ends, it blocks or yields, a deadline job is due or a LOW_LATENCY task
+ * wakes up.
+ *
+ * Every SLICE_PERIOD ticks a feedback controller retunes the slices from
+ * what the period measured per intent: mean wakeup-to-run latency,
+ * context switches and runnable tasks.
+ *
+ *   LOW_LATENCY  1 tick while other tasks compete, else 2
+ *   others       halved when LOW_LATENCY or DEFAULT wakeups miss their
+ *                latency target, otherwise one tick longer per period up
+ *                to the intent's ceiling (PERFORMANCE longest, to keep
+ *                its caches warm)
+ *
+ * The controller leaves the other policies (BASELINE, FAIR, DYNAMIC) on
+ * one tick per decision.
+ */
+
+#include <kernel/htas.h>
+#include <kernel/process.h>
+#include <kernel/pit.h>
+#include <kernel/stdio.h>
+#include <string.h>
+
+#define SLICE_PERIOD        50         /* Ticks per controller step */
+#define LOWLAT_TARGET_TICKS 1          /* LOW_LATENCY wakeup latency target */
+#define DEFAULT_TARGET_TICKS 4         /* DEFAULT wakeup latency target */
+
+static const uint32_t s_ceiling[4] = { 8, 4, 2, 4 };   // By task_intent_t
+
+typedef struct {
+    uint32_t slice;                    // Ticks
+    uint64_t last_switches;            // Stats counters at the last step
+    uint64_t last_runtime_us;
+    uint64_t last_samples;
+    uint64_t last_latency_us;
+    uint32_t runnable_sum;             // Runnable tasks summed over the period
+
+    // Last step, for htas-slice
+    uint32_t switches_per_s;
+    uint32_t latency_us;
+    uint32_t run_per_switch_us;
+    uint32_t runnable_x10;
+} slice_class_t;
+
+static slice_class_t s_class[4];
+static bool s_enabled = true;
+static bool s_preempt = false;         // A LOW_LATENCY task woke since the last pick
+static uint32_t s_ticks = 0;
+static uint32_t s_steps = 0;
+
+static bool active(void) {
+    return s_enabled && htas_get_scheduler() == SCHED_HTAS;
+}
+
+static void reset_classes(void) {
+    scheduler_stats_t* stats = htas_get_stats();
+    for (int i = 0; i < 4; i++) {
+        slice_class_t* c = &s_class[i];
+        memset(c, 0, sizeof(*c));
+        c->slice = (i == PROFILE_LOW_LATENCY) ? 1 : 2;
+        c->last_switches = stats->intent_stats[i].switches;
+        c->last_runtime_us = stats->intent_stats[i].runtime_us;
+        c->last_samples = stats->intent_stats[i].latency_samples;
+        c->last_latency_us = stats->intent_stats[i].latency_total_us;
+    }
+    s_ticks = 0;
+    s_steps = 0;
+}
+
+/* Counter growth since the last step; a stats reset restarts from zero */
+static uint64_t delta(uint64_t now, uint64_t* last) {
+    uint64_t d = (now >= *last) ? now - *last : now;
+    *last = now;
+    return d;
+}
+
+static void step(void) {
+    scheduler_stats_t* stats = htas_get_stats();
+    uint32_t hz = pit_hz();
+    uint32_t total_runnable_x10 = 0;
+
+    for (int i = 0; i < 4; i++) {
+        slice_class_t* c = &s_class[i];
+        uint64_t switches = delta(stats->intent_stats[i].switches, &c->last_switches);
+        uint64_t runtime = delta(stats->intent_stats[i].runtime_us, &c->last_runtime_us);
+        uint64_t samples = delta(stats->intent_stats[i].latency_samples, &c->last_samples);
+        uint64_t latency = delta(stats->intent_stats[i].latency_total_us, &c->last_latency_us);
+
+        c->switches_per_s = (uint32_t)(switches * hz / SLICE_PERIOD);
+        c->latency_us = samples ? (uint32_t)(latency / samples) : 0;
+        c->run_per_switch_us = switches ? (uint32_t)(runtime / switches) : 0;
+        c->runnable_x10 = c->runnable_sum * 10 / SLICE_PERIOD;
+        c->runnable_sum = 0;
+        total_runnable_x10 += c->runnable_x10;
+    }
+
+    bool pressure = s_class[PROFILE_LOW_LATENCY].latency_us > LOWLAT_TARGET_TICKS * htas_tick_us() ||
+                    s_class[PROFILE_DEFAULT].latency_us > DEFAULT_TARGET_TICKS * htas_tick_us();
+
+    for (int i = 0; i < 4; i++) {
+        slice_class_t* c = &s_class[i];
+        if (i == PROFILE_LOW_LATENCY) {
+            c->slice = (total_runnable_x10 > 10) ? 1 : s_ceiling[i];
+        } else if (pressure) {
+            c->slice = (c->slice > 1) ? c->slice / 2 : 1;
+        } else if (c->slice < s_ceiling[i]) {
+            c->slice++;
+        }
+    }
+    s_steps++;
+}
+
+void htas_slice_tick(void) {
+    if (!active()) return;
+
+    process_t* processes = process_get_list();
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        process_t* proc = &processes[i];
+        if (proc->state == PROC_READY || proc->state == PROC_RUNNING) {
+            s_class[htas_task_intent(proc)].runnable_sum++;
+        }
+    }
+
+    if (++s_ticks >= SLICE_PERIOD) {
+        s_ticks = 0;
+        step();
+    }
+}
+
+void htas_slice_wakeup(struct process* proc) {
+    if (htas_task_intent(proc) == PROFILE_LOW_LATENCY) {
+        s_preempt = true;
+    }
+}
+
+/* current was running (process_schedule marked it READY for the pick) */
+bool htas_slice_keep(struct process* current) {
+    bool preempt = s_preempt;
+    s_preempt = false;
+    if (!current) return false;
+
+    bool yielded = current->se.yielded;
+    current->se.yielded = false;
+
+    if (!active() || yielded || current->state != PROC_READY) return false;
+    if (preempt && htas_task_intent(current) != PROFILE_LOW_LATENCY) return false;
+    if (current->se.slice_left <= 1) return false;
+
+    current->se.slice_left--;
+    return true;
+}
+
+void htas_slice_start(struct process* next) {
+    next->se.slice_left = active() ? s_class[htas_task_intent(next)].slice : 1;
+    next->se.yielded = false;
+}
+
+uint32_t htas_slice_ticks(task_intent_t intent) {
+    return active() ? s_class[intent].slice : 1;
+}
+
+void htas_slice_set_enabled(bool enabled) {
+    s_enabled = enabled;
+    reset_classes();
+}
+
+void htas_slice_init(void) {
+    reset_classes();
+}
+
+void htas_slice_print(void) {
+    static const char* names[4] = { "PERFORMANCE", "EFFICIENCY", "LOW_LATENCY", "DEFAULT" };
+
+    printf("[HTAS] Time slices: %s, %u controller steps of %u ticks\n",
+           !s_enabled ? "off (1 tick)" : active() ? "adaptive" : "adaptive (HTAS not active)",
+           s_steps, SLICE_PERIOD);
+    printf("[HTAS] INTENT SLICE(ticks) RUNNABLE(x10) SWITCH/S WAKEUP(us) RUN/SWITCH(us)\n");
+    for (int i = 0; i < 4; i++) {
+        slice_class_t* c = &s_class[i];
+        printf("[HTAS] %s %u %u %u %u %u\n", names[i], htas_slice_ticks((task_intent_t)i),
+               c->runnable_x10, c->switches_per_s, c->latency_us, c->run_per_switch_us);
+    }
+}
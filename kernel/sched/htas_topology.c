@@ -0,0 +1,147 @@
+/* HTAS CPU topology
+ *
+ * Built once at boot. The htas.topo= boot parameter wins, so any P/E
+ * layout can be simulated on any machine; otherwise the CPUs come from the
+ * ACPI MADT and the core type from CPUID. Without a MADT the boot CPU is
+ * the whole machine.
+ */
+
+#include <kernel/htas.h>
+#include <kernel/acpi.h>
+#include <kernel/cpuid.h>
+#include <kernel/bootinfo.h>
+#include <kernel/stdio.h>
+#include <string.h>
+
+#define CPUID_EXT_FEATURES     0x07
+#define CPUID_HYBRID_BIT       (1u << 15)   /* Leaf 7 EDX */
+#define CPUID_HYBRID_LEAF      0x1A
+#define CPUID_CORE_TYPE_ATOM   0x20         /* Leaf 0x1A EAX[31:24] */
+
+/* Until htas_topology_init() runs the scheduler sees just the boot CPU */
+cpu_info_t g_cpu_topology[HTAS_MAX_CPUS] = {
+    { .cpu_id = 0, .type = CPU_TYPE_PCORE, .numa_node = 0, .online = true },
+};
+int g_num_cpus = 1;
+
+static cpu_info_t s_cpus[HTAS_MAX_CPUS];   // Built here, then published
+static int s_count = 0;
+static const char* s_source = "boot CPU only";
+static bool s_override = false;
+
+static void add_cpu(uint32_t apic_id, cpu_type_t type, uint8_t numa_node) {
+    if (s_count >= HTAS_MAX_CPUS) return;
+
+    cpu_info_t* cpu = &s_cpus[s_count];
+    cpu->cpu_id = (uint8_t)s_count;
+    cpu->type = type;
+    cpu->numa_node = numa_node;
+    cpu->online = true;
+    cpu->apic_id = apic_id;
+    s_count++;
+}
+
+/* "PPE:EE": one letter per CPU, ':' moves on to the next NUMA node */
+static int parse_override(const char* spec) {
+    uint8_t node = 0;
+
+    for (const char* p = spec; *p; p++) {
+        switch (*p) {
+            case 'P': case 'p':
+                add_cpu(0, CPU_TYPE_PCORE, node);
+                break;
+            case 'E': case 'e':
+                add_cpu(0, CPU_TYPE_ECORE, node);
+                break;
+            case ':':
+                if (node + 1 < HTAS_MAX_NUMA_NODES) node++;
+                break;
+            default:
+                printf("[HTAS] htas.topo: unexpected '%c', ignoring override\n", *p);
+                s_count = 0;
+                return -1;
+        }
+    }
+    return s_count > 0 ? 0 : -1;
+}
+
+static void discover_madt(void) {
+    const acpi_madt_t* madt = (const acpi_madt_t*)acpi_find_table("APIC");
+    if (!madt) return;
+
+    const uint8_t* p = (const uint8_t*)madt + sizeof(acpi_madt_t);
+    const uint8_t* end = (const uint8_t*)madt + madt->header.length;
+
+    while (p + sizeof(acpi_subtable_t) <= end) {
+        const acpi_subtable_t* sub = (const acpi_subtable_t*)p;
+        if (sub->length < sizeof(acpi_subtable_t) || p + sub->length > end) break;
+
+        if (sub->type == MADT_LOCAL_APIC && sub->length >= sizeof(madt_local_apic_t)) {
+            const madt_local_apic_t* lapic = (const madt_local_apic_t*)sub;
+            if (lapic->flags & (MADT_CPU_ENABLED | MADT_CPU_ONLINE_CAPABLE)) {
+                add_cpu(lapic->apic_id, CPU_TYPE_PCORE, 0);
+            }
+        } else if (sub->type == MADT_LOCAL_X2APIC && sub->length >= sizeof(madt_local_x2apic_t)) {
+            const madt_local_x2apic_t* x2 = (const madt_local_x2apic_t*)sub;
+            if (x2->flags & (MADT_CPU_ENABLED | MADT_CPU_ONLINE_CAPABLE)) {
+                add_cpu(x2->x2apic_id, CPU_TYPE_PCORE, 0);
+            }
+        }
+        p += sub->length;
+    }
+
+    if (s_count > 0) {
+        s_source = "ACPI MADT";
+    }
+}
+
+/* Hybrid parts report the type of the core CPUID runs on */
+static void detect_boot_core_type(void) {
+    uint32_t max_leaf = cpuid_max_leaf();
+    if (max_leaf < CPUID_HYBRID_LEAF) return;
+    if (!(cpuid(CPUID_EXT_FEATURES, 0).edx & CPUID_HYBRID_BIT)) return;
+
+    uint32_t core_type = cpuid(CPUID_HYBRID_LEAF, 0).eax >> 24;
+    uint32_t boot_apic = cpuid(1, 0).ebx >> 24;
+
+    for (int i = 0; i < s_count; i++) {
+        if ((s_cpus[i].apic_id & 0xFF) == boot_apic) {
+            s_cpus[i].type = (core_type == CPUID_CORE_TYPE_ATOM)
+                                   ? CPU_TYPE_ECORE : CPU_TYPE_PCORE;
+        }
+    }
+}
+
+void htas_topology_init(void) {
+    char spec[HTAS_MAX_CPUS + HTAS_MAX_NUMA_NODES + 1];
+
+    s_count = 0;
+    if (bootinfo_param("htas.topo", spec, sizeof(spec)) == 0 && parse_override(spec) == 0) {
+        s_source = "htas.topo override";
+        s_override = true;
+    } else {
+        discover_madt();
+        if (s_count == 0) {
+            add_cpu(cpuid(1, 0).ebx >> 24, CPU_TYPE_PCORE, 0);
+        }
+        detect_boot_core_type();
+    }
+
+    // Entries past the old count are not read until g_num_cpus covers them
+    memcpy(g_cpu_topology, s_cpus, sizeof(s_cpus));
+    g_num_cpus = s_count;
+}
+
+bool htas_topology_is_override(void) {
+    return s_override;
+}
+
+void htas_topology_print(void) {
+    printf("[HTAS] Topology Map (%s, %d CPUs):\n", s_source, g_num_cpus);
+
+    for (int i = 0; i < g_num_cpus; i++) {
+        const char* type_str = (g_cpu_topology[i].type == CPU_TYPE_PCORE) ? "P-Core" : "E-Core";
+        printf("[HTAS]   CPU %d: %s, NUMA Node %d, APIC %u\n",
+               i, type_str, g_cpu_topology[i].numa_node, g_cpu_topology[i].apic_id);
+    }
+}
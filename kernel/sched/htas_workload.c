@@ -0,0 +1,235 @@
+/* HTAS workload recorder
+ *
+ * While recording, every process that is created gets a task slot. Its CPU
+ * use between voluntary blocks (keyboard read, wait()) becomes the run part
+ * of a phase and the time spent blocked becomes the block part, so the
+ * recording captures what the task asked for rather than what the current
+ * policy happened to give it. The result can be saved to a file, loaded
+ * back, and replayed through the simulator (htas_run_replay_benchmark).
+ */
+
+#include <kernel/htas.h>
+#include <kernel/process.h>
+#include <kernel/tsc.h>
+#include <kernel/fs.h>
+#include <kernel/stdio.h>
+#include <string.h>
+
+static wl_trace_t s_trace;
+static bool s_recording = false;
+static uint64_t s_start_tsc;
+
+static uint32_t cycles_to_ms(uint64_t cycles) {
+    return (uint32_t)(tsc_cycles_to_us(cycles) / 1000);
+}
+
+static uint16_t clamp16(uint32_t v) {
+    return (v > 0xFFFF) ? 0xFFFF : (uint16_t)v;
+}
+
+static wl_task_t* slot_of(process_t* proc) {
+    if (!s_recording || proc->se.wl_slot < 0) return NULL;
+    return &s_trace.tasks[proc->se.wl_slot];
+}
+
+static void append_phase(wl_task_t* task, uint32_t run_ms, uint32_t block_ms) {
+    // A block with no CPU use in between extends the previous block
+    if (run_ms == 0 && task->nphases > 0) {
+        wl_phase_t* last = &task->phases[task->nphases - 1];
+        last->block_ms = clamp16(last->block_ms + block_ms);
+        return;
+    }
+    if (task->nphases >= WL_MAX_PHASES) return;
+
+    task->phases[task->nphases].run_ms = clamp16(run_ms);
+    task->phases[task->nphases].block_ms = clamp16(block_ms);
+    task->nphases++;
+}
+
+static uint32_t phase_run_ms(process_t* proc) {
+    htas_entity_t* se = &proc->se;
+    uint64_t used = se->user_cycles + se->sys_cycles;
+    uint32_t ms = cycles_to_ms(used - se->wl_run_base);
+    se->wl_run_base = used;
+    return ms;
+}
+
+static void update_hints(wl_task_t* task, process_t* proc) {
+    task->intent = proc->htas_info ? (uint8_t)proc->htas_info->profile.intent
+                                   : (uint8_t)PROFILE_DEFAULT;
+    task->numa = htas_dyn_numa_node(proc);
+}
+
+void htas_wl_start(void) {
+    memset(&s_trace, 0, sizeof(s_trace));
+    s_start_tsc = tsc_read();
+
+    s_recording = true;
+
+    // Tasks already alive are recorded as arriving at time 0
+    process_t* processes = process_get_list();
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        processes[i].se.wl_slot = -1;
+        if (processes[i].state != PROC_UNUSED && processes[i].state != PROC_ZOMBIE) {
+            htas_wl_task_start(&processes[i]);
+        }
+    }
+    printf("wl: recording (up to %d tasks)\n", WL_MAX_TASKS);
+}
+
+void htas_wl_stop(void) {
+    if (!s_recording) return;
+
+    // Close the open run phase of every task still alive
+    process_t* processes = process_get_list();
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        if (processes[i].state != PROC_UNUSED) {
+            htas_wl_task_exit(&processes[i]);
+        }
+    }
+
+    s_trace.duration_ms = cycles_to_ms(tsc_read() - s_start_tsc);
+    s_recording = false;
+    printf("wl: recorded %u tasks over %u ms\n", s_trace.ntasks, s_trace.duration_ms);
+}
+
+const wl_trace_t* htas_wl_trace(void) {
+    return &s_trace;
+}
+
+void htas_wl_task_start(struct process* proc) {
+    proc->se.wl_slot = -1;
+    if (!s_recording || s_trace.ntasks >= WL_MAX_TASKS) return;
+
+    wl_task_t* task = &s_trace.tasks[s_trace.ntasks];
+    memset(task, 0, sizeof(*task));
+    task->arrival_ms = cycles_to_ms(tsc_read() - s_start_tsc);
+    update_hints(task, proc);
+
+    proc->se.wl_slot = s_trace.ntasks++;
+    proc->se.wl_run_base = proc->se.user_cycles + proc->se.sys_cycles;
+}
+
+void htas_wl_block_begin(struct process* proc) {
+    if (!slot_of(proc)) return;
+    proc->se.wl_block_stamp = tsc_read();
+}
+
+void htas_wl_block_end(struct process* proc) {
+    wl_task_t* task = slot_of(proc);
+    if (!task) return;
+
+    uint32_t block_ms = cycles_to_ms(tsc_read() - proc->se.wl_block_stamp);
+    update_hints(task, proc);
+    append_phase(task, phase_run_ms(proc), block_ms);
+}
+
+void htas_wl_task_exit(struct process* proc) {
+    wl_task_t* task = slot_of(proc);
+    if (!task) return;
+
+    update_hints(task, proc);
+    uint32_t run_ms = phase_run_ms(proc);
+    if (run_ms > 0 || task->nphases == 0) {
+        append_phase(task, run_ms, 0);
+    }
+    proc->se.wl_slot = -1;
+}
+
+void htas_wl_print(void) {
+    const char* intent_name[] = {"PERFORMANCE", "EFFICIENCY", "LOW_LATENCY", "DEFAULT"};
+
+    printf("Workload: %u tasks, %u ms%s\n", s_trace.ntasks, s_trace.duration_ms,
+           s_recording ? " (recording)" : "");
+    for (int i = 0; i < s_trace.ntasks; i++) {
+        const wl_task_t* task = &s_trace.tasks[i];
+        uint32_t run = 0, block = 0;
+        for (int p = 0; p < task->nphases; p++) {
+            run += task->phases[p].run_ms;
+            block += task->phases[p].block_ms;
+        }
+        printf("  T%d: %s NUMA %u, arrives %u ms, %u phases, run %u ms, blocked %u ms\n",
+               i, intent_name[task->intent & 3], task->numa, task->arrival_ms,
+               task->nphases, run, block);
+    }
+}
+
+/* --- File format ------------------------------------------------------- */
+
+int htas_wl_save(const char* name) {
+    int fd = fs_open(name);
+    if (fd < 0) {
+        printf("wl: cannot open %s (the file must already exist)\n", name);
+        return -1;
+    }
+
+    uint8_t hdr[12];
+    memcpy(hdr, "HWL1", 4);
+    memcpy(hdr + 4, &s_trace.ntasks, 2);
+    memset(hdr + 6, 0, 2);
+    memcpy(hdr + 8, &s_trace.duration_ms, 4);
+    int ok = (fs_write(fd, hdr, sizeof(hdr)) == (int)sizeof(hdr));
+
+    for (int i = 0; ok && i < s_trace.ntasks; i++) {
+        const wl_task_t* task = &s_trace.tasks[i];
+        uint8_t thdr[8];
+        thdr[0] = task->intent;
+        thdr[1] = task->numa;
+        memcpy(thdr + 2, &task->nphases, 2);
+        memcpy(thdr + 4, &task->arrival_ms, 4);
+        unsigned phase_bytes = task->nphases * sizeof(wl_phase_t);
+        ok = (fs_write(fd, thdr, sizeof(thdr)) == (int)sizeof(thdr)) &&
+             (fs_write(fd, task->phases, phase_bytes) == (int)phase_bytes);
+    }
+
+    fs_close(fd);
+    if (!ok) {
+        printf("wl: write to %s failed (ext2 writes do not grow files)\n", name);
+        return -1;
+    }
+    printf("wl: saved %u tasks to %s\n", s_trace.ntasks, name);
+    return 0;
+}
+
+int htas_wl_load(const char* name) {
+    int fd = fs_open(name);
+    if (fd < 0) {
+        printf("wl: cannot open %s\n", name);
+        return -1;
+    }
+
+    wl_trace_t* t = &s_trace;
+    uint8_t hdr[12];
+    int ok = (fs_read(fd, hdr, sizeof(hdr)) == (int)sizeof(hdr)) && !memcmp(hdr, "HWL1", 4);
+    if (ok) {
+        memset(t, 0, sizeof(*t));
+        memcpy(&t->ntasks, hdr + 4, 2);
+        memcpy(&t->duration_ms, hdr + 8, 4);
+        ok = (t->ntasks <= WL_MAX_TASKS);
+    }
+
+    for (int i = 0; ok && i < t->ntasks; i++) {
+        wl_task_t* task = &t->tasks[i];
+        uint8_t thdr[8];
+        ok = (fs_read(fd, thdr, sizeof(thdr)) == (int)sizeof(thdr));
+        if (!ok) break;
+        task->intent = thdr[0];
+        task->numa = thdr[1];
+        memcpy(&task->nphases, thdr + 2, 2);
+        memcpy(&task->arrival_ms, thdr + 4, 4);
+        unsigned phase_bytes = task->nphases * sizeof(wl_phase_t);
+        ok = task->intent <= PROFILE_DEFAULT && task->numa < HTAS_MAX_NUMA_NODES &&
+             task->nphases <= WL_MAX_PHASES &&
+             fs_read(fd, task->phases, phase_bytes) == (int)phase_bytes;
+    }
+
+    fs_close(fd);
+    if (!ok) {
+        memset(t, 0, sizeof(*t));
+        printf("wl: %s is not a valid workload file\n", name);
+        return -1;
+    }
+    s_recording = false;
+    printf("wl: loaded %u tasks (%u ms) from %s\n", t->ntasks, t->duration_ms, name);
+    return 0;
+}
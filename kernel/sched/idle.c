@@ -0,0 +1,257 @@
+#include <kernel/idle.h>
+#include <kernel/sched.h>
+#include <kernel/process.h>
+#include <kernel/htas.h>
+#include <kernel/cpuid.h>
+#include <kernel/tsc.h>
+#include <kernel/pit.h>
+#include <kernel/lock.h>
+#include <kernel/stdio.h>
+
+#define CPUID_MONITOR_BIT  (1u << 3)     /* Leaf 1 ECX */
+#define CPUID_MWAIT_LEAF   0x05
+#define MWAIT_ENUM_BIT     (1u << 0)     /* Leaf 5 ECX: EDX counts sub-states */
+
+#define HISTORY            8             /* Idle lengths the governor remembers */
+#define POLL_LIMIT_US      50            /* Then POLL gives way to C1 */
+#define LOWLAT_LIMIT_US    20            /* Exit latency LOW_LATENCY tasks accept */
+#define NO_LIMIT           0xFFFFFFFFu
+
+/* Shallow to deep. Latencies and residencies are typical Intel client
+   figures; power is in the units of the HTAS model (busy P-core = 120) */
+static idle_state_t s_states[IDLE_MAX_STATES] = {
+    { .name = "POLL", .method = IDLE_POLL, .exit_latency_us = 0, .target_residency_us = 0,
+      .power_per_ms = 100, .enabled = true },
+    { .name = "C1", .method = IDLE_HLT, .exit_latency_us = 2, .target_residency_us = 2,
+      .power_per_ms = 30, .enabled = true },
+    { .name = "C1E", .method = IDLE_MWAIT, .hint = 0x01, .exit_latency_us = 10,
+      .target_residency_us = 20, .power_per_ms = 20 },
+    { .name = "C3", .method = IDLE_MWAIT, .hint = 0x10, .exit_latency_us = 70,
+      .target_residency_us = 100, .power_per_ms = 10 },
+    { .name = "C6", .method = IDLE_MWAIT, .hint = 0x20, .exit_latency_us = 85,
+      .target_residency_us = 200, .power_per_ms = 4 },
+};
+static int s_nstates = 5;
+
+static uint8_t s_stack[KSTACK_SIZE] __attribute__((aligned(16)));
+static struct registers* s_frame = 0;
+
+/* mwait watches this line; every interrupt bumps it */
+static volatile uint32_t s_wake_seq __attribute__((aligned(64)));
+
+static volatile int s_cur = -1;         /* State being resided in, -1 when busy */
+static uint64_t s_enter_stamp;
+static uint64_t s_last_tick = 0;        /* TSC at the last timer interrupt */
+static uint32_t s_tick_us = 10000;
+static uint32_t s_predicted_us = 0;
+
+static uint32_t s_history[HISTORY];
+static int s_hist_pos = 0;
+static int s_hist_count = 0;
+
+static void idle_task(void* arg) {
+    (void)arg;
+    for (;;) {
+        idle_wait();
+    }
+}
+
+/* Keep only the mwait hints the CPU lists as supported sub-states */
+static void probe_mwait(void) {
+    if (cpuid_max_leaf() < CPUID_MWAIT_LEAF) return;
+    if (!(cpuid(1, 0).ecx & CPUID_MONITOR_BIT)) return;
+
+    cpuid_regs_t leaf = cpuid(CPUID_MWAIT_LEAF, 0);
+    if (!(leaf.ecx & MWAIT_ENUM_BIT)) return;
+
+    for (int i = 0; i < s_nstates; i++) {
+        idle_state_t* s = &s_states[i];
+        if (s->method != IDLE_MWAIT) continue;
+        uint32_t cstate = (s->hint >> 4) + 1;          // EDX nibble, C0 first
+        uint32_t subs = (leaf.edx >> (cstate * 4)) & 0xF;
+        s->enabled = (s->hint & 0xF) < subs;
+    }
+}
+
+void idle_init(void) {
+    s_tick_us = 1000000 / pit_hz();
+    probe_mwait();
+    s_frame = kthread_frame(s_stack, idle_task, 0);
+
+    printf("idle: states");
+    for (int i = 0; i < s_nstates; i++) {
+        if (s_states[i].enabled) printf(" %s", s_states[i].name);
+    }
+    printf("\n");
+}
+
+struct registers* idle_task_frame(void) {
+    return s_frame;
+}
+
+/* Time left until the next tick, the only timer event */
+static uint32_t next_timer_us(uint64_t now) {
+    if (!s_last_tick) return s_tick_us;
+    uint64_t since = tsc_cycles_to_us(now - s_last_tick);
+    return since < s_tick_us ? s_tick_us - (uint32_t)since : 0;
+}
+
+/* Mean of the recent idle lengths when they agree (deviation under a sixth
+   of the mean, or under 20us). Otherwise the longest are dropped, one per
+   round, in case they were outliers; 0 when no stable pattern remains. */
+static uint32_t typical_us(void) {
+    uint32_t limit = NO_LIMIT;
+
+    for (int round = 0; round <= HISTORY / 4; round++) {
+        uint64_t sum = 0;
+        uint32_t max = 0;
+        int n = 0;
+        for (int i = 0; i < s_hist_count; i++) {
+            if (s_history[i] > limit) continue;
+            sum += s_history[i];
+            if (s_history[i] > max) max = s_history[i];
+            n++;
+        }
+        if (n == 0 || n < (HISTORY * 3) / 4) return 0;
+
+        uint32_t avg = (uint32_t)(sum / n);
+        uint64_t var = 0;
+        for (int i = 0; i < s_hist_count; i++) {
+            if (s_history[i] > limit) continue;
+            int64_t d = (int64_t)s_history[i] - avg;
+            var += (uint64_t)(d * d);
+        }
+        var /= n;
+
+        if (var <= 400 || (uint64_t)avg * avg > var * 36) return avg;
+        limit = max - 1;
+    }
+    return 0;
+}
+
+static uint32_t latency_limit_us(void) {
+    process_t* proc = process_current();
+    if (proc && htas_task_intent(proc) == PROFILE_LOW_LATENCY) return LOWLAT_LIMIT_US;
+    return NO_LIMIT;
+}
+
+/* Deepest enabled state that pays off within the prediction */
+static int select_state(uint32_t predicted, uint32_t latency_limit) {
+    int best = 0;
+    for (int i = 1; i < s_nstates; i++) {
+        idle_state_t* s = &s_states[i];
+        if (!s->enabled) continue;
+        if (s->target_residency_us > predicted || s->exit_latency_us > latency_limit) break;
+        best = i;
+    }
+    return best;
+}
+
+static void idle_enter(int state, uint64_t now) {
+    s_enter_stamp = now;
+    s_cur = state;
+}
+
+/* Called with interrupts off */
+static void idle_exit(uint64_t now) {
+    idle_state_t* s = &s_states[s_cur];
+    uint32_t us = (uint32_t)tsc_cycles_to_us(now - s_enter_stamp);
+
+    s->usage++;
+    s->residency_us += us;
+    if (us < s->target_residency_us) {
+        s->above++;
+    } else {
+        for (int i = s_cur + 1; i < s_nstates; i++) {
+            if (s_states[i].enabled && s_states[i].target_residency_us <= us) {
+                s->below++;
+                break;
+            }
+        }
+    }
+
+    s_history[s_hist_pos] = us;
+    s_hist_pos = (s_hist_pos + 1) % HISTORY;
+    if (s_hist_count < HISTORY) s_hist_count++;
+
+    htas_acct_idle(0, us, s->power_per_ms);   // The boot CPU runs everything
+    s_cur = -1;
+}
+
+void idle_irq_enter(uint8_t irq) {
+    uint64_t now = tsc_read();
+    if (irq == 0) {
+        s_last_tick = now;
+    }
+    s_wake_seq++;
+    if (s_cur >= 0) {
+        idle_exit(now);
+    }
+}
+
+void idle_wait(void) {
+    __asm__ volatile("cli" ::: "memory");
+
+    uint64_t now = tsc_read();
+    uint32_t predicted = next_timer_us(now);
+    uint32_t typical = typical_us();
+    if (typical && typical < predicted) {
+        predicted = typical;
+    }
+    s_predicted_us = predicted;
+
+    int state = select_state(predicted, latency_limit_us());
+    uint32_t seq = s_wake_seq;
+    idle_enter(state, now);
+
+    switch (s_states[state].method) {
+        case IDLE_POLL:
+            __asm__ volatile("sti" ::: "memory");
+            while (s_wake_seq == seq && tsc_cycles_to_us(tsc_read() - now) < POLL_LIMIT_US) {
+                __asm__ volatile("pause" ::: "memory");
+            }
+            __asm__ volatile("cli" ::: "memory");
+            if (s_wake_seq != seq) break;        // The interrupt closed the interval
+            idle_exit(tsc_read());
+            idle_enter(1, tsc_read());
+            __asm__ volatile("sti; hlt" ::: "memory");
+            break;
+        case IDLE_HLT:
+            __asm__ volatile("sti; hlt" ::: "memory");
+            break;
+        case IDLE_MWAIT:
+            __asm__ volatile("monitor" :: "a"(&s_wake_seq), "c"(0), "d"(0));
+            if (s_wake_seq == seq) {
+                __asm__ volatile("sti; mwait" :: "a"(s_states[state].hint), "c"(0) : "memory");
+            }
+            break;
+    }
+
+    // Only a store to the monitored line ends mwait without an interrupt
+    __asm__ volatile("cli" ::: "memory");
+    if (s_cur >= 0) {
+        idle_exit(tsc_read());
+    }
+    __asm__ volatile("sti" ::: "memory");
+}
+
+void idle_print(void) {
+    printf("idle: tick %u us, last prediction %u us, idle power %u/ms (P-core)\n",
+           s_tick_us, s_predicted_us, htas_idle_power_per_ms(CPU_TYPE_PCORE));
+    printf("STATE EXIT TARGET (us) USAGE ABOVE BELOW TIME (ms)\n");
+    for (int i = 0; i < s_nstates; i++) {
+        idle_state_t* s = &s_states[i];
+        if (!s->enabled) continue;
+        printf("%s %u %u %u %u %u %u\n", s->name, s->exit_latency_us, s->target_residency_us,
+               s->usage, s->above, s->below, (uint32_t)(s->residency_us / 1000));
+    }
+}
+
+void idle_reset(void) {
+    uint32_t flags = irq_save();
+    for (int i = 0; i < s_nstates; i++) {
+        s_states[i].usage = s_states[i].above = s_states[i].below = 0;
+        s_states[i].residency_us = 0;
+    }
+    irq_restore(flags);
+}
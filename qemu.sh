@@ -46,6 +46,13 @@ else
 	HAVE_ROOTFS=0
 fi
 
+# Kernel command line: keep the simulated 2P+2E layout unless NUMA=1
+# asks for a real multi-node machine (topology from ACPI MADT/SRAT/SLIT)
+KERNEL_ARGS="htas.topo=PP:EE"
+if [ "${NUMA}" = "1" ]; then
+	KERNEL_ARGS=""
+fi
+
 # Create the grub.cfg file inside the ISO directory
 echo "Creating grub.cfg..."
 cat > isodir/boot/grub/grub.cfg << EOF
@@ -60,7 +67,7 @@ set pager=1
 
 menuentry "jimirOS" {
 	echo "Loading jimir.kernel via Multiboot..."
-	multiboot /boot/jimir.kernel
+	multiboot /boot/jimir.kernel $KERNEL_ARGS
 	module /boot/userprog.elf userprog.elf
 	module /boot/ush.elf ush.elf
 EOF
@@ -114,7 +121,17 @@ if [ "${CURSES}" = "1" ]; then
 	DISPLAY_FLAGS="-display curses"
 fi
 
-QEMU_FLAGS="$QEMU_BASE $DISPLAY_FLAGS $USB_FLAGS"
+# Optional: 4 CPUs on 2 NUMA nodes, 16 MiB each, remote distance 20
+# Use: NUMA=1 ./qemu.sh
+NUMA_FLAGS=""
+if [ "${NUMA}" = "1" ]; then
+	NUMA_FLAGS="-smp 4 \
+		-object memory-backend-ram,id=mem0,size=16M -numa node,nodeid=0,cpus=0-1,memdev=mem0 \
+		-object memory-backend-ram,id=mem1,size=16M -numa node,nodeid=1,cpus=2-3,memdev=mem1 \
+		-numa dist,src=0,dst=1,val=20"
+fi
+
+QEMU_FLAGS="$QEMU_BASE $DISPLAY_FLAGS $USB_FLAGS $NUMA_FLAGS"
 
 if [ -n "$ROOTFS_IMAGE" ]; then
 	if [ "${LEGACY_IDE}" = "1" ]; then
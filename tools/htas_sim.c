@@ -0,0 +1,196 @@
+/* htas_sim - host build of the HTAS simulator
+ *
+ * Compiles the kernel's scheduler sources (kernel/sched/htas*.c) unchanged
+ * against a thin shim for the kernel services they reference, then runs
+ * the htas-sweep grid on all host cores. The CSV is the same one the kernel
+ * writes to serial, in the same row order.
+ *
+ *   htas_sim [-j THREADS] [-d MS] [-o FILE]
+ *   htas_sim -r WORKLOAD        replay a workload saved with `wl save`
+ */
+
+#include <kernel/htas.h>
+#include <kernel/process.h>
+#include <kernel/pit.h>
+#include <kernel/tsc.h>
+#include <kernel/fs.h>
+#include <kernel/kmalloc.h>
+#include <kernel/serial.h>
+#include <kernel/tty.h>
+#include <kernel/trace.h>
+#include <kernel/acpi.h>
+#include <kernel/bootinfo.h>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* ============================================================================
+ * KERNEL SHIM
+ * ============================================================================ */
+
+static process_t g_processes[MAX_PROCESSES];    // Always empty: no live tasks
+
+process_t* process_get_list(void) { return g_processes; }
+process_t* process_current(void) { return NULL; }
+process_t* process_find(int pid) { (void)pid; return NULL; }
+void process_yield(void) { }
+
+/* One thread per simulation and no slot reuse: read sections are free */
+void rcu_read_lock(void) { }
+void rcu_read_unlock(void) { }
+uint32_t irq_save(void) { return 0; }
+void irq_restore(uint32_t flags) { (void)flags; }
+
+static uint64_t host_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* The "TSC" runs at 1 GHz (nanoseconds), the PIT at the kernel's 100 Hz */
+uint64_t tsc_read(void) { return host_ns(); }
+uint32_t tsc_khz(void) { return 1000000; }
+uint64_t tsc_cycles_to_us(uint64_t cycles) { return cycles / 1000; }
+uint64_t pit_ticks(void) { return host_ns() / 10000000ull; }
+uint32_t pit_hz(void) { return 100; }
+
+void* kmalloc(size_t sz) { return malloc(sz); }
+void kfree(void* p) { free(p); }
+
+void serial_writestring(const char* s) { fputs(s, stdout); }
+void terminal_writestring(const char* s) { fputs(s, stderr); }
+
+volatile bool g_trace_enabled = false;
+void trace_emit(uint8_t cpu, trace_type_t type, uint16_t pid, uint16_t arg0, uint16_t arg1) {
+    (void)cpu; (void)type; (void)pid; (void)arg0; (void)arg1;
+}
+
+/* No firmware tables or command line: the topology is the boot CPU */
+const acpi_sdt_header_t* acpi_find_table(const char* signature) { (void)signature; return NULL; }
+int bootinfo_param(const char* key, char* out, unsigned len) { (void)key; (void)out; (void)len; return -1; }
+
+/* Workload files come from the host filesystem */
+int fs_open(const char* name) { return open(name, O_RDWR); }
+int fs_read(int fd, void* buf, unsigned len) { return (int)read(fd, buf, len); }
+int fs_write(int fd, const void* buf, unsigned len) { return (int)write(fd, buf, len); }
+int fs_close(int fd) { return close(fd); }
+
+/* ============================================================================
+ * PARALLEL SWEEP
+ * ============================================================================ */
+
+typedef struct {
+    int points;
+    uint32_t duration_ms;
+    char* rows;                 // points x HTAS_SWEEP_ROW_MAX
+    int next;                   // Next grid point to hand out
+    uint64_t ticks;             // Simulated ticks, all workers
+} sweep_job_t;
+
+static void* sweep_worker(void* arg) {
+    sweep_job_t* job = arg;
+    sim_context_t* ctx = htas_sim_context_alloc();
+    uint64_t ticks = 0;
+
+    if (!ctx) {
+        fprintf(stderr, "htas_sim: out of memory\n");
+        exit(1);
+    }
+
+    for (;;) {
+        int i = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED);
+        if (i >= job->points) break;
+        ticks += htas_sweep_point(ctx, i, job->duration_ms, job->rows + (size_t)i * HTAS_SWEEP_ROW_MAX);
+    }
+
+    __atomic_fetch_add(&job->ticks, ticks, __ATOMIC_RELAXED);
+    kfree(ctx);
+    return NULL;
+}
+
+static int run_sweep(int threads, uint32_t duration_ms, FILE* out) {
+    sweep_job_t job = {
+        .points = htas_sweep_points(),
+        .duration_ms = duration_ms,
+    };
+    job.rows = malloc((size_t)job.points * HTAS_SWEEP_ROW_MAX);
+    pthread_t* tids = malloc(sizeof(pthread_t) * (size_t)threads);
+    if (!job.rows || !tids) {
+        fprintf(stderr, "htas_sim: out of memory\n");
+        return 1;
+    }
+
+    uint64_t start = host_ns();
+    for (int t = 0; t < threads; t++) {
+        if (pthread_create(&tids[t], NULL, sweep_worker, &job) != 0) {
+            fprintf(stderr, "htas_sim: cannot start worker %d\n", t);
+            return 1;
+        }
+    }
+    for (int t = 0; t < threads; t++) {
+        pthread_join(tids[t], NULL);
+    }
+    double secs = (double)(host_ns() - start) / 1e9;
+
+    char header[HTAS_SWEEP_ROW_MAX];
+    htas_sweep_header(header);
+    fputs(header, out);
+    for (int i = 0; i < job.points; i++) {
+        fputs(job.rows + (size_t)i * HTAS_SWEEP_ROW_MAX, out);
+    }
+
+    fprintf(stderr, "%d points, %llu ticks in %.2f s on %d threads (%.1f M ticks/s)\n",
+            job.points, (unsigned long long)job.ticks, secs, threads,
+            secs > 0 ? (double)job.ticks / secs / 1e6 : 0.0);
+
+    free(tids);
+    free(job.rows);
+    return 0;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "usage: %s [-j THREADS] [-d MS] [-o FILE]\n", prog);
+    fprintf(stderr, "       %s -r WORKLOAD\n", prog);
+}
+
+int main(int argc, char** argv) {
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t duration_ms = 1000;
+    const char* out_path = NULL;
+    const char* replay_path = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "j:d:o:r:h")) != -1) {
+        switch (opt) {
+            case 'j': threads = atoi(optarg); break;
+            case 'd': duration_ms = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'o': out_path = optarg; break;
+            case 'r': replay_path = optarg; break;
+            default: usage(argv[0]); return 2;
+        }
+    }
+    if (threads < 1 || duration_ms == 0 || optind != argc) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (replay_path) {
+        if (htas_wl_load(replay_path) != 0) return 1;
+        htas_run_replay_benchmark(htas_wl_trace());
+        return 0;
+    }
+
+    FILE* out = out_path ? fopen(out_path, "w") : stdout;
+    if (!out) {
+        perror(out_path);
+        return 1;
+    }
+    int rc = run_sweep(threads, duration_ms, out);
+    if (out != stdout) fclose(out);
+    return rc;
+}
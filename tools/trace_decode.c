@@ -0,0 +1,174 @@
+/* trace_decode - turn a jimirOS scheduler trace dump into a timeline
+ *
+ * The kernel's `trace dump` writes a binary block framed by "HTRC" ...
+ * "CRTH" to the serial port (see kernel/include/kernel/trace.h). Capture the
+ * serial output to a file and run:
+ *
+ *     ./trace_decode serial.log
+ *
+ * Any text around the block is skipped. Events from all CPUs are merged and
+ * printed in timestamp order, relative to the first event.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    uint64_t tsc;
+    uint8_t  type;
+    uint8_t  cpu;
+    uint16_t pid;
+    uint16_t arg0;
+    uint16_t arg1;
+} trace_event_t;
+
+static const char* type_names[] = { "?", "SWITCH", "WAKEUP", "MIGRATE", "TICK", "PROFILE" };
+static const char* state_names[] = { "UNUSED", "READY", "RUNNING", "BLOCKED", "ZOMBIE" };
+static const char* intent_names[] = { "PERFORMANCE", "EFFICIENCY", "LOW_LATENCY", "DEFAULT" };
+
+static uint16_t rd16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t rd32(const uint8_t* p) { return rd16(p) | ((uint32_t)rd16(p + 2) << 16); }
+static uint64_t rd64(const uint8_t* p) { return rd32(p) | ((uint64_t)rd32(p + 4) << 32); }
+
+/* A dump starting at p whose header is supported and whose every ring
+   fits before end; the magic alone can also turn up inside a payload */
+static int dump_valid(const uint8_t* p, const uint8_t* end) {
+    if (end - p < 12 || memcmp(p, "HTRC", 4) != 0) return 0;
+    if (rd16(p + 4) != 1 || rd32(p + 8) == 0) return 0;
+
+    uint16_t nrings = rd16(p + 6);
+    p += 12;
+    for (unsigned r = 0; r < nrings; r++) {
+        if (end - p < 8) return 0;
+        uint32_t count = rd32(p + 4);
+        p += 8;
+        if ((size_t)(end - p) / 16 < count) return 0;
+        p += (size_t)count * 16;
+    }
+    return 1;
+}
+
+static int cmp_tsc(const void* a, const void* b) {
+    const trace_event_t* x = a;
+    const trace_event_t* y = b;
+    return (x->tsc > y->tsc) - (x->tsc < y->tsc);
+}
+
+static const char* name_of(const char** names, unsigned count, unsigned i) {
+    return (i < count) ? names[i] : "?";
+}
+
+static void print_event(const trace_event_t* ev, uint64_t t0, uint32_t khz) {
+    uint64_t us = ((ev->tsc - t0) * 1000) / khz;
+    printf("%10llu.%03llu ms  cpu%u  %-7s ", (unsigned long long)(us / 1000),
+           (unsigned long long)(us % 1000), ev->cpu,
+           name_of(type_names, 6, ev->type));
+
+    switch (ev->type) {
+    case 1:
+        printf("pid %u -> pid %u (prev %s)\n", ev->pid, ev->arg0,
+               name_of(state_names, 5, ev->arg1));
+        break;
+    case 2:
+        printf("pid %u (%s)\n", ev->pid, name_of(intent_names, 4, ev->arg0));
+        break;
+    case 3:
+        printf("pid %u cpu%u -> cpu%u\n", ev->pid, ev->arg0, ev->arg1);
+        break;
+    case 4:
+        printf("pid %u tick %u\n", ev->pid, ev->arg0);
+        break;
+    case 5:
+        printf("pid %u %s affinity 0x%x\n", ev->pid,
+               name_of(intent_names, 4, ev->arg0), ev->arg1);
+        break;
+    default:
+        printf("pid %u arg0 %u arg1 %u\n", ev->pid, ev->arg0, ev->arg1);
+        break;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s SERIAL_CAPTURE\n", argv[0]);
+        return 2;
+    }
+
+    FILE* f = fopen(argv[1], "rb");
+    if (!f) {
+        perror(argv[1]);
+        return 1;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t* buf = malloc(size > 0 ? (size_t)size : 1);
+    if (!buf || fread(buf, 1, (size_t)size, f) != (size_t)size) {
+        fprintf(stderr, "%s: read failed\n", argv[1]);
+        return 1;
+    }
+    fclose(f);
+
+    /* Use the last complete dump in the capture */
+    const uint8_t* end = buf + size;
+    const uint8_t* p = NULL;
+    for (long i = 0; i + 12 <= size; i++) {
+        if (dump_valid(buf + i, end)) p = buf + i;
+    }
+    if (!p) {
+        fprintf(stderr, "%s: no complete HTRC trace block found\n", argv[1]);
+        return 1;
+    }
+
+    uint16_t version = rd16(p + 4);
+    uint16_t nrings = rd16(p + 6);
+    uint32_t khz = rd32(p + 8);
+    p += 12;
+    if (version != 1 || khz == 0) {
+        fprintf(stderr, "unsupported dump (version %u, %u kHz)\n", version, khz);
+        return 1;
+    }
+
+    trace_event_t* events = NULL;
+    size_t n = 0;
+    for (unsigned r = 0; r < nrings; r++) {
+        if (end - p < 8) goto truncated;
+        uint32_t count = rd32(p + 4);
+        p += 8;
+        if ((size_t)(end - p) < (size_t)count * 16) goto truncated;
+
+        events = realloc(events, (n + count) * sizeof(*events));
+        for (uint32_t i = 0; i < count; i++, p += 16) {
+            trace_event_t* ev = &events[n++];
+            ev->tsc = rd64(p);
+            ev->type = p[8];
+            ev->cpu = p[9];
+            ev->pid = rd16(p + 10);
+            ev->arg0 = rd16(p + 12);
+            ev->arg1 = rd16(p + 14);
+        }
+    }
+    if (end - p < 4 || memcmp(p, "CRTH", 4)) {
+        fprintf(stderr, "warning: trailer missing, dump may be corrupt\n");
+    }
+
+    if (n == 0) {
+        printf("trace is empty\n");
+        return 0;
+    }
+
+    qsort(events, n, sizeof(*events), cmp_tsc);
+    printf("# %zu events, %u rings, TSC %u kHz\n", n, nrings, khz);
+    for (size_t i = 0; i < n; i++) {
+        print_event(&events[i], events[0].tsc, khz);
+    }
+    free(events);
+    free(buf);
+    return 0;
+
+truncated:
+    fprintf(stderr, "dump truncated after %zu events\n", n);
+    return 1;
+}
@@ -21,6 +21,10 @@ sudo cp user/minitest.elf /mnt/jimirfs/ 2>/dev/null || echo "minitest.elf not fo
 sudo cp user/forktest.elf /mnt/jimirfs/ 2>/dev/null || echo "forktest.elf not found"
 sudo cp user/proctest.elf /mnt/jimirfs/ 2>/dev/null || echo "proctest.elf not found"
 sudo cp user/simplefork.elf /mnt/jimirfs/ 2>/dev/null || echo "simplefork.elf not found"
+sudo cp user/sysbench.elf /mnt/jimirfs/ 2>/dev/null || echo "sysbench.elf not found"
+sudo cp user/threadtest.elf /mnt/jimirfs/ 2>/dev/null || echo "threadtest.elf not found"
+sudo cp user/intentbench.elf /mnt/jimirfs/ 2>/dev/null || echo "intentbench.elf not found"
+sudo cp user/hintdemo.elf /mnt/jimirfs/ 2>/dev/null || echo "hintdemo.elf not found"
 
 # List contents
 echo "Filesystem contents:"
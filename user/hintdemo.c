@@ -0,0 +1,79 @@
+/* hintdemo.c - Set a profile with a NUMA data region, pin to a CPU and
+   read back what the scheduler recorded */
+#include "sched.h"
+
+#define BUFFER_SIZE 65536
+
+extern int write(int fd, const char* buf, unsigned len);
+extern int gettid(void);
+
+static void print(const char* s) {
+    unsigned len = 0;
+    while (s[len]) len++;
+    write(1, s, len);
+}
+
+static void print_num(unsigned n) {
+    char buf[16];
+    int i = 0;
+    do {
+        buf[i++] = '0' + (n % 10);
+        n /= 10;
+    } while (n > 0);
+    while (i > 0) {
+        char c = buf[--i];
+        write(1, &c, 1);
+    }
+}
+
+static unsigned char buffer[BUFFER_SIZE];
+
+int main(void) {
+    struct sched_profile profile = {
+        .intent = SCHED_INTENT_PERFORMANCE,
+        .data_region = buffer,
+        .data_size = BUFFER_SIZE,
+    };
+    if (sched_set_profile(0, &profile) != 0) {
+        print("hintdemo: sched_set_profile failed\n");
+        return 1;
+    }
+
+    struct sched_profile back;
+    unsigned long long mask = 0;
+    sched_get_profile(0, &back);
+    sched_set_affinity(0, 1);
+    sched_get_affinity(0, &mask);
+
+    volatile unsigned sum = 0;
+    for (unsigned round = 0; round < 64; round++) {
+        for (unsigned i = 0; i < BUFFER_SIZE; i += 64) {
+            sum += buffer[i]++;
+        }
+    }
+
+    struct sched_stats stats;
+    if (sched_get_stats(0, &stats) != 0) {
+        print("hintdemo: sched_get_stats failed\n");
+        return 1;
+    }
+
+    print("hintdemo: tid ");
+    print_num(gettid());
+    print(" intent ");
+    print_num(back.intent);
+    print(" node ");
+    print_num(stats.numa_node);
+    print(" affinity mask ");
+    print_num((unsigned)mask);
+    print(" runtime ");
+    print_num((unsigned)stats.runtime_us);
+    print(" us (P ");
+    print_num((unsigned)stats.pcore_us);
+    print(", E ");
+    print_num((unsigned)stats.ecore_us);
+    print("), numa penalties ");
+    print_num((unsigned)stats.numa_penalties);
+    print("\n");
+    return 0;
+}
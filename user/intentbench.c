@@ -0,0 +1,111 @@
+/* intentbench.c - Throughput and wakeup latency under each HTAS intent,
+   against a CPU hog thread on the live scheduler */
+#include "thread.h"
+#include "sched.h"
+
+#define RUN_TICKS   50          /* Per intent, half a second at 100Hz */
+#define GAP_NS      50000       /* A longer stall means we were off the CPU */
+#define STACK_SIZE  4096
+
+extern int write(int fd, const char* buf, unsigned len);
+extern unsigned long long vdso_time_ns(void);
+extern unsigned long long vdso_ticks(void);
+
+static const char* names[] = { "PERFORMANCE", "EFFICIENCY", "LOW_LATENCY", "DEFAULT" };
+
+static void print(const char* s) {
+    unsigned len = 0;
+    while (s[len]) len++;
+    write(1, s, len);
+}
+
+static void print_num(unsigned n) {
+    char buf[16];
+    int i = 0;
+    do {
+        buf[i++] = '0' + (n % 10);
+        n /= 10;
+    } while (n > 0);
+    while (i > 0) {
+        char c = buf[--i];
+        write(1, &c, 1);
+    }
+}
+
+static unsigned char hog_stack[STACK_SIZE] __attribute__((aligned(16)));
+static struct thread_tls tls[2];
+static volatile int stop;
+
+static int hog(void* arg) {
+    (void)arg;
+    volatile unsigned spin = 0;
+    while (!stop) spin++;
+    return 0;
+}
+
+/* Low 32 bits of the clock: a gap never comes close to 4s */
+static inline unsigned now_ns(void) {
+    return (unsigned)vdso_time_ns();
+}
+
+static void run(int intent) {
+    struct sched_stats before, after;
+    if (sched_set_intent(0, intent) != 0 || sched_get_stats(0, &before) != 0) {
+        print("intentbench: hint rejected\n");
+        return;
+    }
+
+    unsigned iterations = 0, gaps = 0, gap_total = 0, gap_max = 0;
+    unsigned end = (unsigned)vdso_ticks() + RUN_TICKS;
+    unsigned last = now_ns();
+    while ((int)((unsigned)vdso_ticks() - end) < 0) {
+        unsigned t = now_ns();
+        unsigned gap = t - last;
+        if (gap > GAP_NS) {
+            gaps++;
+            gap_total += gap / 1000;
+            if (gap / 1000 > gap_max) gap_max = gap / 1000;
+        }
+        last = t;
+        iterations++;
+    }
+    sched_get_stats(0, &after);
+
+    unsigned ran_ms = (unsigned)(after.runtime_us - before.runtime_us) / 1000;
+    print(names[intent]);
+    print(": ");
+    print_num(iterations / 1000);
+    print("k loops, ran ");
+    print_num(ran_ms);
+    print(" of ");
+    print_num(RUN_TICKS * 10);
+    print(" ms, ");
+    print_num(gaps);
+    print(" stalls mean ");
+    print_num(gaps ? gap_total / gaps : 0);
+    print(" max ");
+    print_num(gap_max);
+    print(" us, switches ");
+    print_num(after.voluntary_switches - before.voluntary_switches);
+    print("/");
+    print_num(after.involuntary_switches - before.involuntary_switches);
+    print("\n");
+}
+
+int main(void) {
+    thread_set_tls(&tls[0]);
+    int tid = thread_create(hog, 0, hog_stack, STACK_SIZE, &tls[1]);
+    if (tid < 0) {
+        print("intentbench: thread_create failed\n");
+        return 1;
+    }
+    sched_set_intent(tid, SCHED_INTENT_DEFAULT);
+
+    for (int intent = SCHED_INTENT_PERFORMANCE; intent <= SCHED_INTENT_DEFAULT; intent++) {
+        run(intent);
+    }
+
+    stop = 1;
+    thread_join(tid, 0);
+    return 0;
+}
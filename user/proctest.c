@@ -5,6 +5,16 @@ extern int getppid(void);
 extern void exit(int code);
 extern int write(int fd, const char* buf, unsigned len);
 
+struct proc_times {
+    unsigned long long user_us;
+    unsigned long long sys_us;
+    unsigned long long pcore_us;
+    unsigned long long ecore_us;
+    unsigned long long wait_us;
+    unsigned long long iowait_us;
+};
+extern int proc_times(int pid, struct proc_times* out);
+
 static void print(const char* s) {
     unsigned len = 0;
     while (s[len]) len++;
@@ -44,6 +54,21 @@ int main(void) {
     print_num(getppid());
     print("\n");
     
+    // Burn some CPU so there is user time to report
+    volatile unsigned spin = 0;
+    for (unsigned i = 0; i < 20000000u; i++) spin += i;
+
+    struct proc_times t;
+    if (proc_times(0, &t) == 0) {
+        print("CPU time (us): user ");
+        print_num((int)(unsigned)t.user_us);
+        print(" sys ");
+        print_num((int)(unsigned)t.sys_us);
+        print(" wait ");
+        print_num((int)(unsigned)t.wait_us);
+        print("\n");
+    }
+    
     print("\nProcess info retrieved successfully!\n");
     print("Note: fork() requires scheduler integration (TODO)\n");
     
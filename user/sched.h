@@ -0,0 +1,45 @@
+/* sched.h - HTAS hints: intent, NUMA region, affinity and per-task stats */
+#ifndef USER_SCHED_H
+#define USER_SCHED_H
+
+#define SCHED_INTENT_PERFORMANCE 0   /* CPU-bound: P-cores */
+#define SCHED_INTENT_EFFICIENCY  1   /* Background: E-cores */
+#define SCHED_INTENT_LOW_LATENCY 2   /* Interactive: P-cores, priority boost */
+#define SCHED_INTENT_DEFAULT     3   /* No hint */
+
+/* Must match task_profile_t in the kernel */
+struct sched_profile {
+    int intent;
+    void* data_region;               /* Preferred NUMA node follows this */
+    unsigned data_size;
+    unsigned dl_runtime_us;          /* Deadline reservation, all 0 = none */
+    unsigned dl_deadline_us;
+    unsigned dl_period_us;
+};
+
+/* Must match htas_task_stats_t in the kernel */
+struct sched_stats {
+    unsigned intent;
+    unsigned numa_node;
+    unsigned long long affinity;
+    unsigned long long runtime_us;
+    unsigned long long pcore_us;
+    unsigned long long ecore_us;
+    unsigned long long wait_us;
+    unsigned voluntary_switches;
+    unsigned involuntary_switches;
+    unsigned long long numa_penalties;
+};
+
+/* pid (thread id) 0 is the calling thread; others must be threads of the
+   calling process. All return 0 or -1 */
+int sched_set_profile(int pid, const struct sched_profile* profile);
+int sched_get_profile(int pid, struct sched_profile* out);
+int sched_set_affinity(int pid, unsigned long long mask);
+int sched_get_affinity(int pid, unsigned long long* out);
+int sched_get_stats(int pid, struct sched_stats* out);
+
+/* Just the intent, no region or reservation */
+int sched_set_intent(int pid, int intent);
+
+#endif
@@ -0,0 +1,91 @@
+/* sysbench.c - Null system call latency: int 0x80 vs SYSENTER vs vDSO */
+
+#define SYS_getpid 12
+#define ROUNDS     16
+#define CALLS      1000
+
+extern int write(int fd, const char* buf, unsigned len);
+extern int syscall_int80(int nr, int a1, int a2, int a3);
+extern int syscall_sysenter(int nr, int a1, int a2, int a3);
+extern int syscall_fast_available(void);
+extern int vdso_getpid(void);
+
+typedef int (*syscall_fn)(int nr, int a1, int a2, int a3);
+
+static void print(const char* s) {
+    unsigned len = 0;
+    while (s[len]) len++;
+    write(1, s, len);
+}
+
+static void print_num(unsigned n) {
+    char buf[16];
+    int i = 0;
+    do {
+        buf[i++] = '0' + (n % 10);
+        n /= 10;
+    } while (n > 0);
+    while (i > 0) {
+        char c = buf[--i];
+        write(1, &c, 1);
+    }
+}
+
+/* Low half only: a batch is far shorter than 2^32 cycles */
+static inline unsigned rdtsc(void) {
+    unsigned lo, hi;
+    __asm__ volatile ("rdtsc" : "=a"(lo), "=d"(hi));
+    return lo;
+}
+
+/* getpid does no work in the kernel, so this is the entry/exit cost.
+   Best and mean of ROUNDS batches, in cycles per call; the best batch
+   is the one no timer tick landed in. */
+static unsigned bench(const char* name, syscall_fn fn) {
+    unsigned best = ~0u, total = 0;
+
+    fn(SYS_getpid, 0, 0, 0);            // Warm up
+    for (int r = 0; r < ROUNDS; r++) {
+        unsigned t0 = rdtsc();
+        for (int i = 0; i < CALLS; i++) {
+            fn(SYS_getpid, 0, 0, 0);
+        }
+        unsigned t = rdtsc() - t0;
+        total += t;
+        if (t < best) best = t;
+    }
+
+    print(name);
+    print(": best ");
+    print_num(best / CALLS);
+    print(" cycles/call, mean ");
+    print_num(total / (ROUNDS * CALLS));
+    print("\n");
+    return best / CALLS;
+}
+
+/* Same question, answered from the shared page */
+static int vdso_call(int nr, int a1, int a2, int a3) {
+    (void)nr; (void)a1; (void)a2; (void)a3;
+    return vdso_getpid();
+}
+
+int main(void) {
+    print("Null syscall latency (getpid, ");
+    print_num(ROUNDS * CALLS);
+    print(" calls per path)\n");
+
+    unsigned slow = bench("int 0x80", syscall_int80);
+    bench("vdso", vdso_call);
+    if (!syscall_fast_available()) {
+        print("sysenter: not supported by this CPU\n");
+        return 0;
+    }
+    unsigned fast = bench("sysenter", syscall_sysenter);
+    if (fast > 0) {
+        print("speedup: ");
+        print_num(slow * 100 / fast);
+        print("%\n");
+    }
+    return 0;
+}
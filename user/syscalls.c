@@ -1,5 +1,7 @@
 /* syscalls.c - User-space syscall wrappers */
 
+#include "sched.h"
+
 #define SYS_write 1
 #define SYS_exit  2
 #define SYS_read  3
@@ -13,114 +15,189 @@
 #define SYS_wait   11
 #define SYS_getpid 12
 #define SYS_getppid 13
+#define SYS_proc_times 14
+#define SYS_uring_setup 15
+#define SYS_uring_enter 16
+#define SYS_clone   17
+#define SYS_set_tls 18
+#define SYS_gettid  19
+#define SYS_futex_wait 20
+#define SYS_futex_wake 21
+#define SYS_sched_set_profile  22
+#define SYS_sched_get_profile  23
+#define SYS_sched_set_affinity 24
+#define SYS_sched_get_affinity 25
+#define SYS_sched_get_stats    26
 
-int write(int fd, const char* buf, unsigned len) {
-    // Note: kernel SYS_write ignores fd and expects (buf, len) only
-    // We pass fd in ebx but kernel only uses ebx and ecx
+/* Must match proc_times_t in the kernel (microseconds) */
+struct proc_times {
+    unsigned long long user_us;
+    unsigned long long sys_us;
+    unsigned long long pcore_us;
+    unsigned long long ecore_us;
+    unsigned long long wait_us;
+    unsigned long long iowait_us;
+};
+
+/* Trap gate: always available */
+int syscall_int80(int nr, int a1, int a2, int a3) {
     int ret;
     __asm__ volatile (
         "int $0x80"
         : "=a"(ret)
-        : "a"(SYS_write), "b"(buf), "c"(len)
+        : "a"(nr), "b"(a1), "c"(a2), "d"(a3)
         : "memory"
     );
     return ret;
 }
 
-void exit(int code) {
+/* SYSENTER stub: the kernel returns to the address at (%ebp) with esp
+   just above it. SYSEXIT clobbers ecx and edx. */
+__asm__ (
+    ".text\n"
+    ".type sysenter_stub, @function\n"
+    "sysenter_stub:\n"
+    "    pushl %ebp\n"
+    "    pushl $1f\n"
+    "    movl %esp, %ebp\n"
+    "    sysenter\n"
+    "1:  popl %ebp\n"
+    "    ret\n"
+);
+
+int syscall_sysenter(int nr, int a1, int a2, int a3) {
+    int ret;
     __asm__ volatile (
-        "int $0x80"
-        : 
-        : "a"(SYS_exit), "b"(code)
+        "call sysenter_stub"
+        : "=a"(ret), "+c"(a2), "+d"(a3)
+        : "a"(nr), "b"(a1)
         : "memory"
     );
+    return ret;
+}
+
+/* SEP in CPUID.1:EDX; the first Pentium Pro steppings report it falsely */
+int syscall_fast_available(void) {
+    unsigned eax, ebx, ecx, edx;
+    __asm__ volatile ("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(1), "c"(0));
+    unsigned family = (eax >> 8) & 0xF, model = (eax >> 4) & 0xF, stepping = eax & 0xF;
+    if (!(edx & (1u << 11))) return 0;
+    return !(family == 6 && model < 3 && stepping < 3);
+}
+
+static int s_fast = -1;     /* Probed on first use */
+
+static int syscall3(int nr, int a1, int a2, int a3) {
+    if (s_fast < 0) {
+        s_fast = syscall_fast_available();
+    }
+    return s_fast ? syscall_sysenter(nr, a1, a2, a3) : syscall_int80(nr, a1, a2, a3);
+}
+
+int write(int fd, const char* buf, unsigned len) {
+    // Note: kernel SYS_write ignores fd and expects (buf, len) only
+    (void)fd;
+    return syscall3(SYS_write, (int)buf, (int)len, 0);
+}
+
+void exit(int code) {
+    syscall3(SYS_exit, code, 0, 0);
     __builtin_unreachable();
 }
 
 int read(int fd, void* buf, unsigned len) {
-    int ret;
-    __asm__ volatile (
-        "int $0x80"
-        : "=a"(ret)
-        : "a"(SYS_read), "b"(fd), "c"(buf), "d"(len)
-        : "memory"
-    );
-    return ret;
+    return syscall3(SYS_read, fd, (int)buf, (int)len);
 }
 
 int open(const char* path) {
-    int ret;
-    __asm__ volatile (
-        "int $0x80"
-        : "=a"(ret)
-        : "a"(SYS_open), "b"(path)
-        : "memory"
-    );
-    return ret;
+    return syscall3(SYS_open, (int)path, 0, 0);
 }
 
 int close(int fd) {
-    int ret;
-    __asm__ volatile (
-        "int $0x80"
-        : "=a"(ret)
-        : "a"(SYS_close), "b"(fd)
-        : "memory"
-    );
-    return ret;
+    return syscall3(SYS_close, fd, 0, 0);
 }
 
 void* sbrk(int increment) {
-    void* ret;
-    __asm__ volatile (
-        "int $0x80"
-        : "=a"(ret)
-        : "a"(SYS_sbrk), "b"(increment)
-        : "memory"
-    );
-    return ret;
+    return (void*)syscall3(SYS_sbrk, increment, 0, 0);
 }
 
 int fork(void) {
-    int ret;
-    __asm__ volatile (
-        "int $0x80"
-        : "=a"(ret)
-        : "a"(SYS_fork)
-        : "ebx", "ecx", "edx", "esi", "edi", "memory"
-    );
-    return ret;
+    return syscall3(SYS_fork, 0, 0, 0);
 }
 
 int wait(int* status) {
-    int ret;
-    __asm__ volatile (
-        "int $0x80"
-        : "=a"(ret)
-        : "a"(SYS_wait), "b"(status)
-        : "memory"
-    );
-    return ret;
+    return syscall3(SYS_wait, (int)status, 0, 0);
+}
+
+int waitpid(int pid, int* status) {
+    return syscall3(SYS_wait, (int)status, pid, 0);
 }
 
 int getpid(void) {
-    int ret;
-    __asm__ volatile (
-        "int $0x80"
-        : "=a"(ret)
-        : "a"(SYS_getpid)
-        : "memory"
-    );
-    return ret;
+    return syscall3(SYS_getpid, 0, 0, 0);
 }
 
 int getppid(void) {
-    int ret;
-    __asm__ volatile (
-        "int $0x80"
-        : "=a"(ret)
-        : "a"(SYS_getppid)
-        : "memory"
-    );
-    return ret;
+    return syscall3(SYS_getppid, 0, 0, 0);
+}
+
+int gettid(void) {
+    return syscall3(SYS_gettid, 0, 0, 0);
+}
+
+/* The new thread starts at entry on stack with eax = 0 */
+int clone(void* entry, void* stack, void* tls) {
+    return syscall3(SYS_clone, (int)entry, (int)stack, (int)tls);
+}
+
+int set_tls(void* base) {
+    return syscall3(SYS_set_tls, (int)base, 0, 0);
+}
+
+/* Sleep while *addr == val: 0 once woken, -1 if it already differed */
+int futex_wait(volatile int* addr, int val) {
+    return syscall3(SYS_futex_wait, (int)addr, val, 0);
+}
+
+int futex_wake(volatile int* addr, int n) {
+    return syscall3(SYS_futex_wake, (int)addr, n, 0);
+}
+
+int proc_times(int pid, struct proc_times* out) {
+    return syscall3(SYS_proc_times, pid, (int)out, 0);
+}
+
+struct uring;
+
+int uring_setup(struct uring* ring, unsigned entries, unsigned flags) {
+    return syscall3(SYS_uring_setup, (int)ring, (int)entries, (int)flags);
+}
+
+int uring_enter(int id, unsigned to_submit) {
+    return syscall3(SYS_uring_enter, id, (int)to_submit, 0);
+}
+
+int sched_set_profile(int pid, const struct sched_profile* profile) {
+    return syscall3(SYS_sched_set_profile, pid, (int)profile, 0);
+}
+
+int sched_get_profile(int pid, struct sched_profile* out) {
+    return syscall3(SYS_sched_get_profile, pid, (int)out, 0);
+}
+
+int sched_set_affinity(int pid, unsigned long long mask) {
+    return syscall3(SYS_sched_set_affinity, pid, (int)&mask, 0);
+}
+
+int sched_get_affinity(int pid, unsigned long long* out) {
+    return syscall3(SYS_sched_get_affinity, pid, (int)out, 0);
+}
+
+int sched_get_stats(int pid, struct sched_stats* out) {
+    return syscall3(SYS_sched_get_stats, pid, (int)out, 0);
+}
+
+int sched_set_intent(int pid, int intent) {
+    struct sched_profile profile = { .intent = intent };
+    return sched_set_profile(pid, &profile);
 }
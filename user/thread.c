@@ -0,0 +1,66 @@
+/* thread.c - thread_create/join on top of clone() */
+#include "thread.h"
+
+extern int clone(void* entry, void* stack, void* tls);
+extern int set_tls(void* base);
+extern int waitpid(int pid, int* status);
+extern void exit(int code);
+extern int futex_wait(volatile int* addr, int val);
+extern int futex_wake(volatile int* addr, int n);
+
+/* clone() entry: the new stack holds fn then arg. Calling fn leaves arg
+   as its first argument; its return value becomes the exit code. */
+__asm__ (
+    ".text\n"
+    ".type thread_entry, @function\n"
+    "thread_entry:\n"
+    "    popl %eax\n"
+    "    call *%eax\n"
+    "    pushl %eax\n"
+    "    call exit\n"
+);
+extern void thread_entry(void);
+
+int thread_create(thread_fn fn, void* arg, void* stack, unsigned stack_size,
+                  struct thread_tls* tls) {
+    unsigned* sp = (unsigned*)(((unsigned)stack + stack_size) & ~15u);
+    *--sp = 0;                  /* Padding: fn is entered with esp + 4 */
+    *--sp = 0;                  /* 16-byte aligned, as the ABI expects */
+    *--sp = 0;
+    *--sp = (unsigned)arg;
+    *--sp = (unsigned)fn;
+
+    tls->self = tls;
+    return clone((void*)thread_entry, sp, tls);
+}
+
+int thread_join(int tid, int* code) {
+    return waitpid(tid, code) == tid ? 0 : -1;
+}
+
+int thread_set_tls(struct thread_tls* tls) {
+    tls->self = tls;
+    return set_tls(tls);
+}
+
+void thread_mutex_lock(thread_mutex_t* m) {
+    int c = 0;
+    if (__atomic_compare_exchange_n(&m->state, &c, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return;
+    }
+    // Contended: mark it so the holder's unlock wakes someone, then sleep
+    if (c != 2) {
+        c = __atomic_exchange_n(&m->state, 2, __ATOMIC_ACQUIRE);
+    }
+    while (c != 0) {
+        futex_wait(&m->state, 2);
+        c = __atomic_exchange_n(&m->state, 2, __ATOMIC_ACQUIRE);
+    }
+}
+
+void thread_mutex_unlock(thread_mutex_t* m) {
+    if (__atomic_fetch_sub(&m->state, 1, __ATOMIC_RELEASE) != 1) {
+        __atomic_store_n(&m->state, 0, __ATOMIC_RELEASE);
+        futex_wake(&m->state, 1);
+    }
+}
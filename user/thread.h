@@ -0,0 +1,43 @@
+/* thread.h - User threads on clone(): shared memory, own stack and TLS */
+#ifndef USER_THREAD_H
+#define USER_THREAD_H
+
+/* Start of every TLS block; %gs:0 points back at it (i386 TLS ABI) */
+struct thread_tls {
+    struct thread_tls* self;
+    void* user;                 /* Free for the program */
+};
+
+typedef int (*thread_fn)(void* arg);
+
+/* Run fn(arg) in a new thread on [stack, stack + stack_size) with tls as
+   its TLS block. fn's return value is the thread's exit code. Returns
+   the thread id or -1. */
+int thread_create(thread_fn fn, void* arg, void* stack, unsigned stack_size,
+                  struct thread_tls* tls);
+
+/* Wait for a thread of this process; 0 with its exit code, or -1 */
+int thread_join(int tid, int* code);
+
+/* Give the calling thread (usually the first) a TLS block */
+int thread_set_tls(struct thread_tls* tls);
+
+/* Futex mutex: 0 unlocked, 1 locked, 2 locked with sleepers. Lock and
+   unlock stay in user space unless another thread holds or waits. */
+typedef struct {
+    volatile int state;
+} thread_mutex_t;
+
+#define THREAD_MUTEX_INIT { 0 }
+
+void thread_mutex_lock(thread_mutex_t* m);
+void thread_mutex_unlock(thread_mutex_t* m);
+
+/* The calling thread's TLS block, read through %gs */
+static inline struct thread_tls* thread_self(void) {
+    struct thread_tls* self;
+    __asm__ volatile ("movl %%gs:0, %0" : "=r"(self));
+    return self;
+}
+
+#endif
@@ -0,0 +1,100 @@
+/* threadtest.c - Threads sharing memory, each with its own stack and TLS,
+   and a futex mutex around a shared counter */
+#include "thread.h"
+
+#define NTHREADS    4
+#define STACK_SIZE  4096
+#define ITEMS       4096
+#define LOCKED_ADDS 20000
+
+extern int write(int fd, const char* buf, unsigned len);
+extern int getpid(void);
+extern int gettid(void);
+extern void exit(int code);
+
+static void print(const char* s) {
+    unsigned len = 0;
+    while (s[len]) len++;
+    write(1, s, len);
+}
+
+static void print_num(unsigned n) {
+    char buf[16];
+    int i = 0;
+    do {
+        buf[i++] = '0' + (n % 10);
+        n /= 10;
+    } while (n > 0);
+    while (i > 0) {
+        char c = buf[--i];
+        write(1, &c, 1);
+    }
+}
+
+static unsigned char stacks[NTHREADS][STACK_SIZE] __attribute__((aligned(16)));
+static struct thread_tls tls[NTHREADS + 1];
+static unsigned data[ITEMS];
+static unsigned partial[NTHREADS];
+static volatile unsigned finished;
+static thread_mutex_t lock = THREAD_MUTEX_INIT;
+static unsigned counter;                        // Only under lock
+
+/* Sums its slice of data; which slice comes from its own TLS block */
+static int worker(void* arg) {
+    unsigned index = (unsigned)thread_self()->user;
+    unsigned sum = 0;
+    for (unsigned i = index; i < ITEMS; i += NTHREADS) {
+        sum += data[i];
+    }
+    partial[index] = sum;
+    for (int i = 0; i < LOCKED_ADDS; i++) {
+        thread_mutex_lock(&lock);
+        counter++;
+        thread_mutex_unlock(&lock);
+    }
+    __atomic_fetch_add(&finished, 1, __ATOMIC_SEQ_CST);
+    return (arg == &tls[index]) ? 0 : 1;        // TLS and argument agree
+}
+
+int main(void) {
+    thread_set_tls(&tls[NTHREADS]);
+    unsigned expect = 0;
+    for (unsigned i = 0; i < ITEMS; i++) {
+        data[i] = i;
+        expect += i;
+    }
+
+    int tids[NTHREADS];
+    for (int t = 0; t < NTHREADS; t++) {
+        tls[t].user = (void*)t;
+        tids[t] = thread_create(worker, &tls[t], stacks[t], STACK_SIZE, &tls[t]);
+        if (tids[t] < 0) {
+            print("threadtest: thread_create failed\n");
+            exit(1);
+        }
+    }
+
+    int failed = 0;
+    unsigned total = 0;
+    for (int t = 0; t < NTHREADS; t++) {
+        int code = -1;
+        if (thread_join(tids[t], &code) != 0 || code != 0) failed++;
+        total += partial[t];
+    }
+
+    print("threadtest: pid ");
+    print_num(getpid());
+    print(", main tid ");
+    print_num(gettid());
+    print(", ");
+    print_num(finished);
+    print(" threads, sum ");
+    print_num(total);
+    print(", locked count ");
+    print_num(counter);
+    int ok = total == expect && counter == NTHREADS * LOCKED_ADDS && failed == 0 &&
+             thread_self() == &tls[NTHREADS];
+    print(ok ? " OK\n" : " FAILED\n");
+    exit(ok ? 0 : 1);               // _start exits with 0 whatever main returns
+    return 0;
+}
@@ -0,0 +1,77 @@
+/* uring.c - Shared-ring I/O: batch many operations per trap, or none */
+
+#include "uring.h"
+
+extern void* sbrk(int increment);
+extern int uring_setup(struct uring* ring, unsigned entries, unsigned flags);
+extern int uring_enter(int id, unsigned to_submit);
+
+int uring_init(struct uring_handle* h, unsigned entries, unsigned flags) {
+    unsigned size = sizeof(struct uring) +
+                    entries * (sizeof(struct uring_sqe) + sizeof(struct uring_cqe));
+    struct uring* ring = (struct uring*)sbrk((int)size);
+    if ((int)ring == -1 || !ring) return -1;
+
+    int id = uring_setup(ring, entries, flags);
+    if (id < 0) return -1;
+
+    h->id = id;
+    h->ring = ring;
+    h->sqes = (struct uring_sqe*)(ring + 1);
+    h->cqes = (struct uring_cqe*)(h->sqes + entries);
+    h->mask = entries - 1;
+    h->sq_tail = ring->sq_tail;
+    h->enters = 0;
+    return 0;
+}
+
+struct uring_sqe* uring_get_sqe(struct uring_handle* h) {
+    unsigned head = __atomic_load_n(&h->ring->sq_head, __ATOMIC_ACQUIRE);
+    if (h->sq_tail - head > h->mask) return 0;
+
+    struct uring_sqe* sqe = &h->sqes[h->sq_tail & h->mask];
+    h->sq_tail++;
+    sqe->opcode = URING_OP_NOP;
+    sqe->flags = 0;
+    sqe->reserved = 0;
+    sqe->fd = -1;
+    sqe->addr = 0;
+    sqe->len = 0;
+    sqe->user_data = 0;
+    return sqe;
+}
+
+void uring_prep(struct uring_sqe* sqe, int op, int fd, const void* addr, unsigned len, unsigned user_data) {
+    sqe->opcode = (unsigned char)op;
+    sqe->fd = fd;
+    sqe->addr = (unsigned)addr;
+    sqe->len = len;
+    sqe->user_data = user_data;
+}
+
+int uring_submit(struct uring_handle* h) {
+    unsigned pending = h->sq_tail - h->ring->sq_tail;
+    __atomic_store_n(&h->ring->sq_tail, h->sq_tail, __ATOMIC_RELEASE);
+    if (h->ring->flags & URING_SETUP_SQPOLL) return (int)pending;
+    h->enters++;
+    return uring_enter(h->id, pending);
+}
+
+struct uring_cqe* uring_wait_cqe(struct uring_handle* h) {
+    unsigned head = h->ring->cq_head;
+    while (__atomic_load_n(&h->ring->cq_tail, __ATOMIC_ACQUIRE) == head) {
+        if (!(h->ring->flags & URING_SETUP_SQPOLL)) {
+            // Entries the CQ had no room for are still queued
+            h->enters++;
+            if (uring_enter(h->id, h->sq_tail - h->ring->sq_head) <= 0 &&
+                h->ring->cq_tail == head) {
+                return 0;
+            }
+        }
+    }
+    return &h->cqes[head & h->mask];
+}
+
+void uring_cqe_seen(struct uring_handle* h) {
+    __atomic_store_n(&h->ring->cq_head, h->ring->cq_head + 1, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,62 @@
+/* uring.h - User side of the shared submission/completion rings */
+#ifndef USER_URING_H
+#define USER_URING_H
+
+#define URING_SETUP_SQPOLL 0x1
+
+#define URING_OP_NOP   0
+#define URING_OP_READ  1
+#define URING_OP_WRITE 2
+#define URING_OP_OPEN  3
+#define URING_OP_CLOSE 4
+
+/* Must match the kernel's uring_sqe_t / uring_cqe_t / uring_t */
+struct uring_sqe {
+    unsigned char opcode;
+    unsigned char flags;
+    unsigned short reserved;
+    int fd;
+    unsigned addr;
+    unsigned len;
+    unsigned user_data;
+};
+
+struct uring_cqe {
+    unsigned user_data;
+    int res;
+};
+
+struct uring {
+    volatile unsigned sq_head;
+    volatile unsigned sq_tail;
+    volatile unsigned cq_head;
+    volatile unsigned cq_tail;
+    unsigned entries;
+    unsigned flags;
+};
+
+struct uring_handle {
+    int id;
+    struct uring* ring;
+    struct uring_sqe* sqes;
+    struct uring_cqe* cqes;
+    unsigned mask;
+    unsigned sq_tail;       /* Prepared, not yet published */
+    unsigned enters;        /* Traps taken, for the curious */
+};
+
+/* entries: power of two, at most 256. 0 or -1. */
+int uring_init(struct uring_handle* h, unsigned entries, unsigned flags);
+
+/* Next free submission slot, zeroed; 0 when the SQ is full */
+struct uring_sqe* uring_get_sqe(struct uring_handle* h);
+void uring_prep(struct uring_sqe* sqe, int op, int fd, const void* addr, unsigned len, unsigned user_data);
+
+/* Publish prepared entries; traps once unless a kernel poller is running */
+int uring_submit(struct uring_handle* h);
+
+/* Oldest completion, waiting for it if needed; then mark it seen */
+struct uring_cqe* uring_wait_cqe(struct uring_handle* h);
+void uring_cqe_seen(struct uring_handle* h);
+
+#endif
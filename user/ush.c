@@ -16,6 +16,8 @@ static inline int sys_close(int fd){ int r; __asm__ volatile("int $0x80":"=a"(r)
 static inline int sys_fs_list(char* buf, unsigned n){ int r; __asm__ volatile("int $0x80":"=a"(r):"a"(SYS_fs_list),"b"(buf),"c"(n):"memory","cc"); return r; }
 static inline int sys_fwrite(int fd, const void* buf, unsigned n){ int r; __asm__ volatile("int $0x80":"=a"(r):"a"(SYS_fwrite),"b"(fd),"c"(buf),"d"(n):"memory","cc"); return r; }
 
+#include "uring.h"
+
 static unsigned strlen(const char* s){ unsigned n=0; while(s[n]) n++; return n; }
 static void puts(const char* s){ sys_write(s, strlen(s)); }
 static int streq(const char* a, const char* b){ while(*a && (*a==*b)){a++;b++;} return (unsigned char)*a - (unsigned char)*b; }
@@ -34,6 +36,62 @@ static void cmd_cat(const char* name){
     puts("\n");
 }
 
+/* cat through a shared ring: CAT_BATCH reads per trap, then their writes
+   in one more; with a polled ring, no traps at all after the open */
+#define CAT_BATCH 8
+#define CAT_CHUNK 256
+
+static struct uring_handle s_ring, s_pring;
+static int s_ring_ok = -1, s_pring_ok = -1;
+
+static void cmd_rcat(const char* name, int polled){
+    struct uring_handle* r = polled ? &s_pring : &s_ring;
+    int* ok = polled ? &s_pring_ok : &s_ring_ok;
+    if (*ok < 0) *ok = (uring_init(r, 16, polled ? URING_SETUP_SQPOLL : 0) == 0);
+    if (!*ok) { cmd_cat(name); return; }       // No ring: plain syscalls
+
+    if (!name||!*name){ puts("usage: cat NAME\n"); return; }
+    int fd = sys_open(name);
+    if (fd < 0) { puts("cat: not found\n"); return; }
+
+    static char buf[CAT_BATCH][CAT_CHUNK];
+    unsigned enters = r->enters;
+    int eof = 0;
+    while (!eof) {
+        int n[CAT_BATCH];
+        for (int i = 0; i < CAT_BATCH; i++) {
+            uring_prep(uring_get_sqe(r), URING_OP_READ, fd, buf[i], CAT_CHUNK, (unsigned)i);
+        }
+        uring_submit(r);
+        for (int i = 0; i < CAT_BATCH; i++) {
+            struct uring_cqe* cqe = uring_wait_cqe(r);
+            n[cqe ? cqe->user_data : (unsigned)i] = cqe ? cqe->res : -1;
+            if (cqe) uring_cqe_seen(r);
+        }
+
+        int writes = 0;
+        for (int i = 0; i < CAT_BATCH && !eof; i++) {
+            if (n[i] <= 0) { eof = 1; break; }
+            uring_prep(uring_get_sqe(r), URING_OP_WRITE, 1, buf[i], (unsigned)n[i], (unsigned)i);
+            writes++;
+            if (n[i] < CAT_CHUNK) eof = 1;
+        }
+        if (writes) {
+            uring_submit(r);
+            for (int i = 0; i < writes; i++) {
+                if (uring_wait_cqe(r)) uring_cqe_seen(r);
+            }
+        }
+    }
+    sys_close(fd);
+
+    char num[12]; int k = 0; unsigned t = r->enters - enters;
+    do { num[k++] = (char)('0' + t % 10); t /= 10; } while (t);
+    puts("\n[");
+    while (k) { char c = num[--k]; sys_write(&c, 1); }
+    puts(" ring enters]\n");
+}
+
 static void cmd_write(const char* name){
     if (!name||!*name){ puts("usage: write NAME (type a line)\n"); return; }
     int fd = sys_open(name);
@@ -43,7 +101,7 @@ static void cmd_write(const char* name){
 }
 
 void main(void){
-    puts("ush: tiny user shell. Commands: ls, cat NAME, write NAME, exit\n");
+    puts("ush: tiny user shell. Commands: ls, cat NAME, rcat NAME, pcat NAME, write NAME, exit\n");
     char line[128];
     for(;;){
         puts("u$ ");
@@ -58,7 +116,9 @@ void main(void){
         if (streq(cmd,"exit")==0) { sys_exit(0); }
         else if (streq(cmd,"ls")==0) { cmd_ls(); }
         else if (streq(cmd,"cat")==0) { cmd_cat(has_arg?p:0); }
+        else if (streq(cmd,"rcat")==0) { cmd_rcat(has_arg?p:0, 0); }
+        else if (streq(cmd,"pcat")==0) { cmd_rcat(has_arg?p:0, 1); }
         else if (streq(cmd,"write")==0) { cmd_write(has_arg?p:0); }
-        else { puts("unknown. try ls/cat/exit\n"); }
+        else { puts("unknown. try ls/cat/rcat/pcat/exit\n"); }
     }
 }
@@ -0,0 +1,80 @@
+/* vdso.c - Time and identity from the kernel's shared page, no syscall */
+
+#define VDSO_ADDR  0xFFFFE000u
+#define VDSO_SHIFT 20
+
+/* Must match vdso_data_t in the kernel */
+struct vdso_data {
+    volatile unsigned seq;
+    unsigned version;
+    unsigned tsc_mult;
+    unsigned tick_hz;
+    unsigned long long tsc_base;
+    unsigned long long ns_base;
+    unsigned long long ticks;
+    int pid;
+    int ppid;
+};
+
+#define VDSO ((const volatile struct vdso_data*)VDSO_ADDR)
+
+/* Seqlock read: retry while the kernel is mid-update or finished one
+   while we were reading */
+static inline unsigned read_begin(void) {
+    unsigned seq;
+    while ((seq = VDSO->seq) & 1) { }
+    __asm__ volatile ("" ::: "memory");
+    return seq;
+}
+
+static inline int read_retry(unsigned seq) {
+    __asm__ volatile ("" ::: "memory");
+    return VDSO->seq != seq;
+}
+
+static inline unsigned long long rdtsc(void) {
+    unsigned lo, hi;
+    __asm__ volatile ("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((unsigned long long)hi << 32) | lo;
+}
+
+/* Nanoseconds since boot */
+unsigned long long vdso_time_ns(void) {
+    unsigned long long ns;
+    unsigned seq;
+    do {
+        seq = read_begin();
+        ns = VDSO->ns_base;
+        if (VDSO->tsc_mult) {
+            ns += ((rdtsc() - VDSO->tsc_base) * VDSO->tsc_mult) >> VDSO_SHIFT;
+        }
+    } while (read_retry(seq));
+    return ns;
+}
+
+/* Timer ticks since boot */
+unsigned long long vdso_ticks(void) {
+    unsigned long long t;
+    unsigned seq;
+    do {
+        seq = read_begin();
+        t = VDSO->ticks;
+    } while (read_retry(seq));
+    return t;
+}
+
+/* Seconds since boot, as SYS_time reports them */
+unsigned vdso_time(void) {
+    unsigned hz = VDSO->tick_hz;
+    return hz ? (unsigned)vdso_ticks() / hz : 0;
+}
+
+/* Rewritten only on a context switch, so whoever reads them is the
+   task they describe */
+int vdso_getpid(void) {
+    return VDSO->pid;
+}
+
+int vdso_getppid(void) {
+    return VDSO->ppid;
+}